@@ -0,0 +1,20 @@
+/*
+ * Replacements of the global operator new and delete that count the
+ * allocations of each thread for Instrumentation. Linked into main and
+ * bench only; anything else including Compiler.h keeps the default ones.
+ */
+
+#include <cstdlib>
+#include <new>
+#include "Instrumentation.h"
+
+void * operator new(size_t size) {
+	allocationCount()++;
+	void * p = malloc(size ? size : 1);
+	if (!p) throw bad_alloc();
+	return p;
+}
+
+void operator delete(void * p) noexcept {
+	free(p);
+}
@@ -0,0 +1,78 @@
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <vector>
+#include <type_traits>
+#include "arena_ptr.h"
+
+using namespace std;
+
+/**
+ * Owns the nodes of the parse tree of one compilation. Nodes are placed one
+ * after the other into large chunks and are never freed one by one; the
+ * arena destroys them all at once. Not thread safe, every thread parsing
+ * uses its own arena and they are spliced together afterwards.
+ */
+class Arena {
+public:
+	Arena() : used(chunkSize) { }
+
+	~Arena() {
+		for (int i = destructors.size() - 1; i >= 0; i--) destructors[i].second(destructors[i].first);
+		for (int i = 0; i < chunks.size(); i++) free(chunks[i]);
+	}
+
+	template <class T, class... Args>
+	arena_ptr<T> make(Args &&... args) {
+		T * node = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+		if (!is_trivially_destructible<T>::value) destructors.push_back(make_pair(static_cast<void *>(node), &destroy<T>));
+		return arena_ptr<T>(node);
+	}
+
+	// takes over all nodes of other, which is left empty
+	void splice(Arena & other) {
+		// in front of the chunk being filled, which stays the last one
+		chunks.insert(chunks.end() - (chunks.empty() ? 0 : 1), other.chunks.begin(), other.chunks.end());
+		destructors.insert(destructors.end(), other.destructors.begin(), other.destructors.end());
+		other.chunks.clear();
+		other.destructors.clear();
+		other.used = chunkSize;
+	}
+
+private:
+	static const size_t chunkSize = 64 * 1024;
+
+	// the last chunk is the one being filled
+	vector<char *> chunks;
+	size_t used;
+	vector<pair<void *, void (*)(void *)> > destructors;
+
+	Arena(const Arena &);
+	Arena & operator=(const Arena &);
+
+	void * allocate(size_t size, size_t align) {
+		size_t start = (used + align - 1) & ~(align - 1);
+		if (start + size > chunkSize) {
+			// objects larger than a chunk get a chunk of their own
+			char * chunk = static_cast<char *>(malloc(size > chunkSize ? size : chunkSize));
+			if (size > chunkSize) {
+				chunks.insert(chunks.end() - (chunks.empty() ? 0 : 1), chunk);
+				return chunk;
+			}
+			chunks.push_back(chunk);
+			start = 0;
+		}
+		used = start + size;
+		return chunks.back() + start;
+	}
+
+	template <class T>
+	static void destroy(void * node) {
+		static_cast<T *>(node)->~T();
+	}
+};
+
+#endif
@@ -5,40 +5,42 @@
 #include <string>
 #include <vector>
 #include "Picture.h"
+#include "SymmetryView.h"
 #include "Token.h"
 #include "Set.h"
-#include "counted_ptr.h"
+#include "Term.h"
+#include "arena_ptr.h"
 
 
 class Expression {
 public:
 	Expression() { }
 
-	Expression(counted_ptr<Set> pLeft, counted_ptr<Set> pRight) 
+	Expression(arena_ptr<Set> pLeft, arena_ptr<Set> pRight) 
 		: left(pLeft), right(pRight) {  }
 
 	~Expression() {
 	}
 
-	counted_ptr<Set> getLeft() {
+	arena_ptr<Set> getLeft() {
 		return left;
 	}
 
-	counted_ptr<Set> getRight() {
+	arena_ptr<Set> getRight() {
 		return right;
 	}
 
-	void setLeft(counted_ptr<Set> pLeft) {
+	void setLeft(arena_ptr<Set> pLeft) {
 		left = pLeft;
 	}
 
-	void setRight(counted_ptr<Set> pRight) {
+	void setRight(arena_ptr<Set> pRight) {
 		right = pRight;
 	}
 
 private:
-	counted_ptr<Set> left;
-	counted_ptr<Set> right;
+	arena_ptr<Set> left;
+	arena_ptr<Set> right;
 };
 
 enum RelationalOperator {
@@ -54,15 +56,15 @@ class Constraint {
 public:
 	Constraint() : op(OP_EQ_EQ) { }
 
-	counted_ptr<Term> getLeft() {return left;}
-	counted_ptr<Term> getRight() {return right;}
-	void setLeft(counted_ptr<Term> l) {left = l;}
-	void setRight(counted_ptr<Term> r) {right = r;}
+	arena_ptr<Term> getLeft() {return left;}
+	arena_ptr<Term> getRight() {return right;}
+	void setLeft(arena_ptr<Term> l) {left = l;}
+	void setRight(arena_ptr<Term> r) {right = r;}
 
 	RelationalOperator getOp() {return op;}
 	void setOp(RelationalOperator o) {op = o;}
 private:
-	counted_ptr<Term> left, right;
+	arena_ptr<Term> left, right;
 	RelationalOperator op;
 };
 
@@ -81,18 +83,24 @@ class CellStatement {
 public:	
 	CellStatement() : type(EMPTY) {}
 
-	CellStatement(CellStatementType type, int identNumber, counted_ptr<Set> pSet) 
+	// shared by all empty cells, never changed
+	static arena_ptr<CellStatement> empty() {
+		static CellStatement emptyCell;
+		return arena_ptr<CellStatement>(&emptyCell);
+	}
+
+	CellStatement(CellStatementType type, int identNumber, arena_ptr<Set> pSet) 
 		: type(type), identNumber(identNumber), set(pSet){ }
-	CellStatement(CellStatementType type, counted_ptr<Term> term, counted_ptr<Set> pSet) 
+	CellStatement(CellStatementType type, arena_ptr<Term> term, arena_ptr<Set> pSet) 
 		: type(type), term(term), set(pSet){ }
 
 	int getIdentNumber() {return identNumber;}	
-	counted_ptr<Set> getSet() {return set;}
-	counted_ptr<Term> getTerm() {return  term;}
+	arena_ptr<Set> getSet() {return set;}
+	arena_ptr<Term> getTerm() {return  term;}
 	
 	CellStatementType getType() {return type;}
 
-	void setContent(CellStatementType pType, int pIdentNumber, counted_ptr<Term> pTerm, counted_ptr<Set> pSet) {
+	void setContent(CellStatementType pType, int pIdentNumber, arena_ptr<Term> pTerm, arena_ptr<Set> pSet) {
 		type = pType;
 		identNumber = pIdentNumber;
 		set = pSet;
@@ -115,46 +123,57 @@ public:
 private:
 	CellStatementType type;
 	int identNumber;
-	counted_ptr<Set> set;
-	counted_ptr<Term> term;
+	arena_ptr<Set> set;
+	arena_ptr<Term> term;
 };
 
 
 class Head {
 public:
-	Head() : cell(new Picture<counted_ptr<CellStatement>>(counted_ptr<CellStatement>(new CellStatement()))) {  }
+	// the picture is made by the Parser
+	Head() {  }
 	
-	counted_ptr<Picture<counted_ptr<CellStatement>>> getCell() {
+	arena_ptr<Picture<arena_ptr<CellStatement>>> getCell() {
 		return cell;
 	}
+	void setCell(arena_ptr<Picture<arena_ptr<CellStatement>>> nc) {
+		cell = nc;
+	}
 
 	vector<Expression> & getExpressions() {
 		return expressions;
 	}
 
 private:
-	counted_ptr<Picture<counted_ptr<CellStatement>>> cell;
+	arena_ptr<Picture<arena_ptr<CellStatement>>> cell;
 	vector<Expression> expressions;
 };
 
 class Block {
 public:
+	// the pictures are made by the Parser
 	Block() 
-	: left (new Picture<counted_ptr<CellStatement>>(counted_ptr<CellStatement>(new CellStatement())))
-	, right(new Picture<counted_ptr<CellStatement>>(counted_ptr<CellStatement>(new CellStatement())))
-	, turn90(false), turn180(false), turn270(false), e(false), mx(false), my(false) { 
-		static int blockNbr = 0;
-		blockIdent = blockNbr++;
+	: blockIdent(-1), turn90(false), turn180(false), turn270(false), e(false), mx(false), my(false) { 
 	}
 
-	counted_ptr<Picture<counted_ptr<CellStatement>>> getLeft() {
+	// the left picture in the orientation of this block
+	const SymmetryView & getLeft() {
 		return left;
 	}
 	
-	counted_ptr<Picture<counted_ptr<CellStatement>>> getRight() {
+	arena_ptr<Picture<arena_ptr<CellStatement>>> getRight() {
 		return right;
 	}
-	void setRight(counted_ptr<Picture<counted_ptr<CellStatement>>> nr) {
+	void setLeft(arena_ptr<Picture<arena_ptr<CellStatement>>> nl) {
+		left = SymmetryView(nl, SYM_IDENTITY, xMain, yMain, 1, 1);
+	}
+
+	Symmetry getSymmetry() {return left.getSymmetry();}
+	// the picture has to be parsed and the main cell set before
+	void setSymmetry(Symmetry symmetry, int cellX, int cellY) {
+		left = SymmetryView(left.getSource(), symmetry, xMain, yMain, cellX, cellY);
+	}
+	void setRight(arena_ptr<Picture<arena_ptr<CellStatement>>> nr) {
 		right = nr;
 	}
 
@@ -162,11 +181,18 @@ public:
 		return blockIdent;
 	}
 
-	int getX() {return xMain;}
-	int getY() {return yMain;}
+	// the index of the block in CellFile::blocks, set when it is added
+	void setBlockIdent(int ident) {
+		blockIdent = ident;
+	}
+
+	int getX() {return left.getX();}
+	int getY() {return left.getY();}
+	// the main cell in the picture as parsed
 	void setXY(int x, int y) {
 		xMain = x;
 		yMain = y;
+		left = SymmetryView(left.getSource(), SYM_IDENTITY, xMain, yMain, 1, 1);
 	}
 	
 	bool getTurn90()  {return turn90;}
@@ -187,8 +213,8 @@ public:
 
 	vector<Constraint> & getConstraints() {return constraints;}
 private:
-	counted_ptr<Picture<counted_ptr<CellStatement>>> left;
-	counted_ptr<Picture<counted_ptr<CellStatement>>> right;
+	SymmetryView left;
+	arena_ptr<Picture<arena_ptr<CellStatement>>> right;
 	int xMain = 0;
     int yMain = 0;
     int blockIdent;
@@ -0,0 +1,83 @@
+#ifndef _BLOCK_PROFILE_H_
+#define _BLOCK_PROFILE_H_
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <utility>
+
+using namespace std;
+
+/**
+ * Hit counts per block as written by the instrumented cpp_code, one line
+ * "block <index> <hits>" per block, index being the position in file.blocks.
+ */
+class BlockProfile {
+public:
+	BlockProfile() { }
+
+	bool read(const string & fileName) {
+		ifstream inStream(fileName);
+		if (!inStream) return false;
+		string word;
+		int block;
+		unsigned long long n;
+		while (inStream >> word >> block >> n) {
+			if (word != "block") return false;
+			hits[block] += n;
+		}
+		return inStream.eof();
+	}
+
+	/**
+	 * Used to feed the static coverage of the function analysis in when
+	 * there is no runtime profile.
+	 */
+	void addHits(int block, unsigned long long n) {
+		hits[block] += n;
+	}
+
+	bool empty() {
+		return hits.empty();
+	}
+
+	unsigned long long getHits(int block) {
+		map<int, unsigned long long>::iterator it = hits.find(block);
+		return (it == hits.end()) ? 0 : it->second;
+	}
+
+	/**
+	 * Order in which the blocks are tested, the most frequently firing first.
+	 * A block only overtakes earlier blocks it never fires together with
+	 * (pairs in overlapping are (earlier, later) block indices), so the
+	 * priority of the original order and therefore 'else' stay valid.
+	 */
+	vector<int> order(int nBlocks, const set<pair<int, int>> & overlapping) {
+		vector<int> result;
+		vector<int> waitingFor(nBlocks, 0);
+		vector<bool> placed(nBlocks, false);
+		for (set<pair<int, int>>::const_iterator it = overlapping.begin(); it != overlapping.end(); it++)
+			waitingFor[it->second]++;
+
+		for (int n = 0; n < nBlocks; n++) {
+			int best = -1;
+			for (int i = 0; i < nBlocks; i++) {
+				if (placed[i] || waitingFor[i] > 0) continue;
+				if (best < 0 || getHits(i) > getHits(best)) best = i;
+			}
+			placed[best] = true;
+			result.push_back(best);
+			for (set<pair<int, int>>::const_iterator it = overlapping.lower_bound(make_pair(best, 0));
+				it != overlapping.end() && it->first == best; it++)
+				waitingFor[it->second]--;
+		}
+		return result;
+	}
+
+private:
+	map<int, unsigned long long> hits;
+};
+
+#endif
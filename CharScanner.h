@@ -0,0 +1,112 @@
+#ifndef _CHAR_SCANNER_H_
+#define _CHAR_SCANNER_H_
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * Scans a line of text for the characters the lexer has to look at, 32
+ * (AVX2) or 16 (SSE2) bytes at a time, bytewise where neither is available.
+ * The mask holds 0xff for every byte that reads as a space (text already
+ * turned into tokens), it may be NULL.
+ */
+class CharScanner {
+public:
+	// first position in [from, length) not holding c, length if there is none
+	static int skip(const char * chars, const unsigned char * mask, int from, int length, char c) {
+		int x = from;
+#if defined(__AVX2__)
+		const __m256i spaces = _mm256_set1_epi8(' '), wanted = _mm256_set1_epi8(c);
+		for (; x + 32 <= length; x += 32) {
+			__m256i v = effective(chars, mask, x, spaces);
+			unsigned int other = ~(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, wanted));
+			if (other) return x + __builtin_ctz(other);
+		}
+#elif defined(__SSE2__)
+		const __m128i spaces = _mm_set1_epi8(' '), wanted = _mm_set1_epi8(c);
+		for (; x + 16 <= length; x += 16) {
+			__m128i v = effective(chars, mask, x, spaces);
+			unsigned int other = ~_mm_movemask_epi8(_mm_cmpeq_epi8(v, wanted)) & 0xffff;
+			if (other) return x + __builtin_ctz(other);
+		}
+#endif
+		while (x < length && at(chars, mask, x) == c) x++;
+		return x;
+	}
+
+	/**
+	 * First position in [from, length) holding a structural character, that
+	 * is anything but spaces, letters, digits, '-', '_' and '.'.
+	 */
+	static int findStructural(const char * chars, const unsigned char * mask, int from, int length) {
+		int x = from;
+#if defined(__AVX2__)
+		const __m256i spaces = _mm256_set1_epi8(' ');
+		for (; x + 32 <= length; x += 32) {
+			__m256i v = effective(chars, mask, x, spaces);
+			__m256i plain = _mm256_or_si256(
+				_mm256_or_si256(_mm256_cmpeq_epi8(v, spaces), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('-'))),
+				_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('.'))));
+			plain = _mm256_or_si256(plain, inRange(v, '0', '9'));
+			plain = _mm256_or_si256(plain, inRange(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z'));
+			unsigned int structural = ~(unsigned int)_mm256_movemask_epi8(plain);
+			if (structural) return x + __builtin_ctz(structural);
+		}
+#elif defined(__SSE2__)
+		const __m128i spaces = _mm_set1_epi8(' ');
+		for (; x + 16 <= length; x += 16) {
+			__m128i v = effective(chars, mask, x, spaces);
+			__m128i plain = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(v, spaces), _mm_cmpeq_epi8(v, _mm_set1_epi8('-'))),
+				_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('_')), _mm_cmpeq_epi8(v, _mm_set1_epi8('.'))));
+			plain = _mm_or_si128(plain, inRange(v, '0', '9'));
+			plain = _mm_or_si128(plain, inRange(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z'));
+			unsigned int structural = ~_mm_movemask_epi8(plain) & 0xffff;
+			if (structural) return x + __builtin_ctz(structural);
+		}
+#endif
+		while (x < length && isPlain(at(chars, mask, x))) x++;
+		return x;
+	}
+
+private:
+	static char at(const char * chars, const unsigned char * mask, int x) {
+		return (mask && mask[x]) ? ' ' : chars[x];
+	}
+
+	static bool isPlain(char c) {
+		return c == ' ' || c == '-' || c == '_' || c == '.'
+			|| (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z');
+	}
+
+#if defined(__AVX2__)
+	static __m256i effective(const char * chars, const unsigned char * mask, int x, __m256i spaces) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(chars + x));
+		if (!mask) return v;
+		__m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(mask + x));
+		return _mm256_or_si256(_mm256_andnot_si256(m, v), _mm256_and_si256(m, spaces));
+	}
+
+	// bytes in [lo, hi], compared signed after shifting lo to -128
+	static __m256i inRange(__m256i v, char lo, char hi) {
+		__m256i shifted = _mm256_add_epi8(v, _mm256_set1_epi8((char)(-128 - lo)));
+		return _mm256_cmpgt_epi8(_mm256_set1_epi8((char)(-128 + (hi - lo) + 1)), shifted);
+	}
+#elif defined(__SSE2__)
+	static __m128i effective(const char * chars, const unsigned char * mask, int x, __m128i spaces) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(chars + x));
+		if (!mask) return v;
+		__m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mask + x));
+		return _mm_or_si128(_mm_andnot_si128(m, v), _mm_and_si128(m, spaces));
+	}
+
+	// bytes in [lo, hi], compared signed after shifting lo to -128
+	static __m128i inRange(__m128i v, char lo, char hi) {
+		__m128i shifted = _mm_add_epi8(v, _mm_set1_epi8((char)(-128 - lo)));
+		return _mm_cmplt_epi8(shifted, _mm_set1_epi8((char)(-128 + (hi - lo) + 1)));
+	}
+#endif
+};
+
+#endif
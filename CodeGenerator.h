@@ -11,12 +11,12 @@
 #include "Lexer.h"
 #include "Set.h"
 #include "BasicData.h"
-#include "Variable.h"
+#include "SymbolTable.h"
 
 class CodeGenerator {
 public:
-	CodeGenerator(StringTable & strTable, map<int, counted_ptr<Variable>> & varTable, string name) 
-	: varTable(varTable), strTable(strTable), posSet(counted_ptr<Set>(new Set())) {
+	CodeGenerator(StringTable & strTable, SymbolTable & varTable, string name) 
+	: varTable(varTable), strTable(strTable), posSet(Set::empty()) {
 		outStream.open(name + ".h");
 	}
 
@@ -29,7 +29,7 @@ public:
 		cellY = program.head.getCell()->getHeight();
 		posSet.setSize(cellX, cellY);
 
-		counted_ptr<Picture<counted_ptr<CellStatement>>> pic = program.head.getCell();
+		arena_ptr<Picture<arena_ptr<CellStatement>>> pic = program.head.getCell();
 		for (int i = 0; i < cellX; i++)
 			for (int j = 0; j < cellY; j++) {
 				if (pic->get(i,j)->getType() != EMPTY) {
@@ -55,13 +55,13 @@ public:
 	}
 
 private:
-	map<int, counted_ptr<Variable>> & varTable;
+	SymbolTable & varTable;
 	StringTable & strTable;
 	stringstream error;
 	//string getNeighbors, giveNeighbors;
 
 	int cellX, cellY;
-	Picture<counted_ptr<Set>> posSet;
+	Picture<arena_ptr<Set>> posSet;
 	ofstream outStream;
 
 
@@ -142,10 +142,10 @@ private:
 	}
 
 
-	bool isIdentInSet(counted_ptr<Set> set) {
+	bool isIdentInSet(arena_ptr<Set> set) {
 		if (set->getType() == SET_IDENTIFIER) {
 			SetIdentifier* s1 = static_cast<SetIdentifier*>(set.get());
-			return isIdentInSet(static_cast<VariableSet*>(varTable[s1->getName()].get())->getSet());
+			return isIdentInSet(varTable.getSet(s1->getName()));
 		
 		} else if (set->getType() == SET_ENUM) {
 			return static_cast<SetList*>(set.get())->getIdentifiers().size();
@@ -201,18 +201,18 @@ private:
 
 	void translateBlock(Block & block) {
 		outStream << "if (";
-		counted_ptr<Picture<counted_ptr<CellStatement>>> pic = block.getLeft();
+		const SymmetryView & pic = block.getLeft();
 		bool b = false;
-		for (int i = 0; i < pic->getWidth(); i++) {
-			for (int j = 0; j < pic->getHeight(); j++) {
-				if (pic->get(i,j)->getType() != EMPTY && pic->get(i,j)->getType() != SET_ONLY) {
+		for (int i = 0; i < pic.getWidth(); i++) {
+			for (int j = 0; j < pic.getHeight(); j++) {
+				if (pic.get(i,j)->getType() != EMPTY && pic.get(i,j)->getType() != SET_ONLY) {
 					// if (no variable initialization) not that important
-					if (pic->get(i,j)->getType() != CELL_IDENTIFIER && pic->get(i,j)->getType() != IDENTIFIER_IN_SET) {
+					if (pic.get(i,j)->getType() != CELL_IDENTIFIER && pic.get(i,j)->getType() != IDENTIFIER_IN_SET) {
 						if (b) outStream << " &&" << endl << "     ";
 						b = true;
 						translateCondition(block, i, j);
-					} else if (varTable[pic->get(i,j)->getIdentNumber()]->getType() == VAR_CONTENT) {
-						VariableContent::Koord k = static_cast<VariableContent *>(varTable[pic->get(i,j)->getIdentNumber()].get())->getKoord(block.getBlockIdent());
+					} else if (varTable.is(pic.get(i,j)->getIdentNumber(), VAR_CONTENT)) {
+						VariableContent::Koord k = varTable.getContent(pic.get(i,j)->getIdentNumber()).getKoord(block.getBlockIdent());
 						if (k.x != i || k.y != j) {
 							if (b) outStream << " &&" << endl << "     ";
 							b = true;
@@ -227,11 +227,11 @@ private:
 			}
 		}
 
-		for (int i = 0; i < pic->getWidth(); i++) {
-			for (int j = 0; j < pic->getHeight(); j++) {
-				if (pic->get(i,j)->getType() == IDENTIFIER_IN_SET || 
-					pic->get(i,j)->getType() == TERM_IN_SET || 
-					pic->get(i,j)->getType() == SET_ONLY) {
+		for (int i = 0; i < pic.getWidth(); i++) {
+			for (int j = 0; j < pic.getHeight(); j++) {
+				if (pic.get(i,j)->getType() == IDENTIFIER_IN_SET || 
+					pic.get(i,j)->getType() == TERM_IN_SET || 
+					pic.get(i,j)->getType() == SET_ONLY) {
 					
 					if (b) outStream << " &&" << endl << "     ";
 					b = true;
@@ -240,7 +240,7 @@ private:
 					if (isIdentInSet(i-block.getX(), j-block.getY())) {
 						idents = true;
 					}
-					translateSet(block, pic->get(i,j)->getSet(), idents, i, j);
+					translateSet(block, pic.get(i,j)->getSet(), idents, i, j);
 				}
 			}
 		}
@@ -269,16 +269,16 @@ private:
 	}
 
 	bool translateCondition(Block & block, int x, int y) {
-		counted_ptr<CellStatement> c = block.getLeft()->get(x,y);
+		arena_ptr<CellStatement> c = block.getLeft().get(x,y);
 		
 		getCell(block, x, y);
 		outStream << " == ";
 		if (c->getType() == CELL_IDENTIFIER || c->getType() == IDENTIFIER_IN_SET) {
 		
-			if (varTable[c->getIdentNumber()]->getType() == SET_CONTENT) {
+			if (varTable.is(c->getIdentNumber(), SET_CONTENT)) {
 				outStream << '"' << strTable.getString(c->getIdentNumber()) << '"';
-			} else if (varTable[c->getIdentNumber()]->getType() == VAR_CONTENT) {
-				VariableContent::Koord koord = static_cast<VariableContent *>(varTable[c->getIdentNumber()].get())->getKoord(block.getBlockIdent());
+			} else if (varTable.is(c->getIdentNumber(), VAR_CONTENT)) {
+				VariableContent::Koord koord = varTable.getContent(c->getIdentNumber()).getKoord(block.getBlockIdent());
 				getCell(block, koord.x, koord.y);
 			}
 
@@ -301,7 +301,7 @@ private:
 	}*/
 
 	void translateResult(Block & block) {
-		counted_ptr<Picture<counted_ptr<CellStatement>>> pic = block.getRight();
+		arena_ptr<Picture<arena_ptr<CellStatement>>> pic = block.getRight();
 		for (int i = 0; i < pic->getWidth(); i++)
 			for (int j = 0; j < pic->getHeight(); j++) {
 				if (pic->get(i,j)->getType() != EMPTY) {
@@ -310,10 +310,10 @@ private:
 					case CELL_NUMBER:
 						outStream << pic->get(i,j)->getIdentNumber();break;
 					case CELL_IDENTIFIER:	
-						if (varTable[pic->get(i,j)->getIdentNumber()]->getType() == SET_CONTENT) {
+						if (varTable.is(pic->get(i,j)->getIdentNumber(), SET_CONTENT)) {
 							outStream << '"' << strTable.getString(pic->get(i,j)->getIdentNumber()) << '"';
-						} else  if (varTable[pic->get(i,j)->getIdentNumber()]->getType() == VAR_CONTENT) {
-							VariableContent::Koord koord = static_cast<VariableContent *>(varTable[pic->get(i,j)->getIdentNumber()].get())->getKoord(block.getBlockIdent());
+						} else  if (varTable.is(pic->get(i,j)->getIdentNumber(), VAR_CONTENT)) {
+							VariableContent::Koord koord = varTable.getContent(pic->get(i,j)->getIdentNumber()).getKoord(block.getBlockIdent());
 							getCell(block, koord.x, koord.y);
 						}
 						break;
@@ -375,10 +375,10 @@ private:
 	/*
 	void writeSetFunctions(CellFile & file) {
 		for (int i = 0; i < file.blocks.size(); i++) {
-			counted_ptr<Picture<counted_ptr<CellStatement>>> pic = file.blocks[i].getLeft();
-			for (int x = 0; x < pic->getWidth(); x++)
-				for (int y = 0; y < pic->getHeight(); y++) {
-					if (pic->get(x,y)->getType() == SET_ONLY || pic->get(x,y)->getType() == IDENTIFIER_IN_SET) {
+			const SymmetryView & pic = file.blocks[i].getLeft();
+			for (int x = 0; x < pic.getWidth(); x++)
+				for (int y = 0; y < pic.getHeight(); y++) {
+					if (pic.get(x,y)->getType() == SET_ONLY || pic.get(x,y)->getType() == IDENTIFIER_IN_SET) {
 						outStream << "	bool inSet" << file.blocks[i].getBlockIdent();
 						getCell(file.blocks[i], x, y, false);
 						outStream << "(";
@@ -391,17 +391,17 @@ private:
 							outStream << "int i";
 						}
 						outStream << ") {" << endl;
-						//translateSet(file.blocks[i], pic->get(x,y)->getSet(), b);
+						//translateSet(file.blocks[i], pic.get(x,y)->getSet(), b);
 						outStream << "		return b1;" << endl << "	}" << endl << endl;
 					}
 				}
 		}
 	}*/
 
-	void translateSet(Block & block, counted_ptr<Set> set, bool idents, int x, int y) {
+	void translateSet(Block & block, arena_ptr<Set> set, bool idents, int x, int y) {
 
 		switch(set->getType()) {
-		case SET_IDENTIFIER:	translateSet(block, static_cast<VariableSet*>(varTable[static_cast<SetIdentifier*>(set.get())->getName()].get())->getSet(), idents, x, y); break;
+		case SET_IDENTIFIER:	translateSet(block, varTable.getSet(static_cast<SetIdentifier*>(set.get())->getName()), idents, x, y); break;
 		case SET_ENUM:		{
 								SetList * setL = static_cast<SetList *>(set.get());
 									
@@ -419,10 +419,10 @@ private:
 										else b = true;
 										getCell(block,x,y);
 										outStream << " == ";
-										if (varTable[setL->getIdentifiers()[j]]->getType() == SET_CONTENT) {
+										if (varTable.is(setL->getIdentifiers()[j], SET_CONTENT)) {
 											outStream << '"' << strTable.getString(setL->getIdentifiers()[j]) << '"';
-										} else if (varTable[setL->getIdentifiers()[j]]->getType() == VAR_CONTENT) {
-											VariableContent::Koord koord = static_cast<VariableContent *>(varTable[setL->getIdentifiers()[j]].get())->getKoord(block.getBlockIdent());
+										} else if (varTable.is(setL->getIdentifiers()[j], VAR_CONTENT)) {
+											VariableContent::Koord koord = varTable.getContent(setL->getIdentifiers()[j]).getKoord(block.getBlockIdent());
 											getCell(block, koord.x, koord.y);
 										}
 									}
@@ -438,8 +438,8 @@ private:
 										else b = true;
 										getCell(block,x,y);
 										outStream << " == ";
-										if (varTable[setL->getIdentifiers()[j]]->getType() == VAR_CONTENT) {
-											VariableContent::Koord koord = static_cast<VariableContent *>(varTable[setL->getIdentifiers()[j]].get())->getKoord(block.getBlockIdent());
+										if (varTable.is(setL->getIdentifiers()[j], VAR_CONTENT)) {
+											VariableContent::Koord koord = varTable.getContent(setL->getIdentifiers()[j]).getKoord(block.getBlockIdent());
 											getCell(block, koord.x, koord.y);
 										}
 									}
@@ -468,10 +468,10 @@ private:
 		}
 	}
 	
-	/*void translateSet(Block & block, counted_ptr<Set> set, bool idents, int counter = 1) {
+	/*void translateSet(Block & block, arena_ptr<Set> set, bool idents, int counter = 1) {
 
 		switch(set->getType()) {
-		case SET_IDENTIFIER:	translateSet(block, static_cast<VariableSet*>(varTable[static_cast<SetIdentifier*>(set.get())->getName()].get())->getSet(), idents, counter); break;
+		case SET_IDENTIFIER:	translateSet(block, varTable.getSet(static_cast<SetIdentifier*>(set.get())->getName()), idents, counter); break;
 		case SET_ENUM:		{
 								outStream << "		bool b" << counter << " = ";
 								SetList * setL = static_cast<SetList *>(set.get());
@@ -487,10 +487,10 @@ private:
 									for (int j = 0; j < setL->getIdentifiers().size(); j++) {
 										if (b) outStream << " ||" << endl << "			   ";
 										else b = true;
-										if (varTable[setL->getIdentifiers()[j]]->getType() == SET_CONTENT) {
+										if (varTable.is(setL->getIdentifiers()[j], SET_CONTENT)) {
 											outStream << "str == " << '"' << strTable.getString(setL->getIdentifiers()[j]) << '"';
-										} else if (varTable[setL->getIdentifiers()[j]]->getType() == VAR_CONTENT) {
-											VariableContent::Koord koord = static_cast<VariableContent *>(varTable[setL->getIdentifiers()[j]].get())->getKoord(block.getBlockIdent());
+										} else if (varTable.is(setL->getIdentifiers()[j], VAR_CONTENT)) {
+											VariableContent::Koord koord = varTable.getContent(setL->getIdentifiers()[j]).getKoord(block.getBlockIdent());
 											outStream << "str == ";
 											getCell(block, koord.x, koord.y);
 										}
@@ -504,8 +504,8 @@ private:
 									for (int j = 0; j < setL->getIdentifiers().size(); j++) {
 										if (b) outStream << " ||" << endl << "			   ";
 										else b = true;
-										if (varTable[setL->getIdentifiers()[j]]->getType() == VAR_CONTENT) {
-											VariableContent::Koord koord = static_cast<VariableContent *>(varTable[setL->getIdentifiers()[j]].get())->getKoord(block.getBlockIdent());
+										if (varTable.is(setL->getIdentifiers()[j], VAR_CONTENT)) {
+											VariableContent::Koord koord = varTable.getContent(setL->getIdentifiers()[j]).getKoord(block.getBlockIdent());
 											outStream << "i == ";
 											getCell(block, koord.x, koord.y);
 										}
@@ -558,15 +558,13 @@ private:
 		}
 	}*/
 
-	void translateTerm(counted_ptr<Term> t, Block & b) {
+	void translateTerm(arena_ptr<Term> t, Block & b) {
 		switch(t->getType()) {
 		case T_NUMBER:		outStream << static_cast<TermIdentNumber*>(t.get())->getIdentName();
 							break;
 		case T_IDENTIFIER:	{
 								// can only pass semantics test if this Identifier is a locally initialized VariableContent
-								VariableContent::Koord k = static_cast<VariableContent*>(
-									varTable[static_cast<TermIdentNumber*>(t.get())->getIdentName()].get())
-									->getKoord(b.getBlockIdent());
+								VariableContent::Koord k = varTable.getContent(static_cast<TermIdentNumber*>(t.get())->getIdentName()).getKoord(b.getBlockIdent());
 								getCell(b, k.x, k.y);
 								break;
 							}
@@ -0,0 +1,134 @@
+#ifndef _COMPILE_CACHE_H_
+#define _COMPILE_CACHE_H_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <functional>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "Fnv.h"
+
+using namespace std;
+
+/**
+ * The generated files of earlier compilations, one directory per entry
+ * named by the hash of everything that went into them. Entries are written
+ * to a temporary directory first and renamed, so processes and threads can
+ * share a cache. Outputs are copied and not linked: the stages truncate
+ * their files when they open them, that would reach into a linked entry.
+ */
+class CompileCache {
+public:
+	CompileCache(const string & dir) : dir(dir) { }
+
+	// the files of a rule file named name0 + suffix
+	static const vector<string> & suffixes() {
+		static const vector<string> list = {".zac", "_analysis.txt", ".table", ".coverage"};
+		return list;
+	}
+
+	/**
+	 * FNV-1a, 64 bit, continued from h, over the length of text and then its
+	 * bytes. With the length first, parts hashed one after the other cannot
+	 * shift into each other.
+	 */
+	static unsigned long long hash(const string & text, unsigned long long h = Fnv::offset64) {
+		unsigned long long length = text.size();
+		for (int i = 0; i < 8; i++) h = Fnv::step64(h, (unsigned char)(length >> (8 * i)));
+		for (size_t i = 0; i < text.size(); i++) h = Fnv::step64(h, text[i]);
+		return h;
+	}
+
+	/**
+	 * Rule text without the spaces and carriage returns at the end of a line,
+	 * the lexer skips those. Anything else, a tab too, is an error or a token
+	 * to the lexer and stays.
+	 */
+	static string significant(const string & text) {
+		string kept;
+		kept.reserve(text.size());
+		size_t blanks = 0;
+		for (size_t i = 0; i < text.size(); i++) {
+			char c = text[i];
+			if (c == ' ' || c == '\r') {
+				blanks++;
+				continue;
+			}
+			if (c != '\n')
+				for (size_t j = i - blanks; j < i; j++) kept.push_back(text[j]);
+			blanks = 0;
+			kept.push_back(c);
+		}
+		return kept;
+	}
+
+	static string hex(unsigned long long h) {
+		char buffer[17];
+		snprintf(buffer, sizeof(buffer), "%016llx", h);
+		return buffer;
+	}
+
+	/**
+	 * Copies the files of entry key to name0 + suffix and returns what was
+	 * stored with them in meta. False if there is no such entry.
+	 */
+	bool fetch(const string & key, const string & name0, string & meta) {
+		string entry = dir + "/" + key;
+		if (!readFile(entry + "/meta", meta)) return false;
+		for (int i = 0; i < suffixes().size(); i++)
+			if (!copyFile(entry + "/" + suffixes()[i], name0 + suffixes()[i])) return false;
+		return true;
+	}
+
+	// the files name0 + suffix and meta as entry key, unless it is there already
+	void store(const string & key, const string & name0, const string & meta) {
+		mkdir(dir.c_str(), 0755);
+		string entry = dir + "/" + key;
+		struct stat info;
+		if (stat(entry.c_str(), &info) == 0) return;
+		stringstream tmp;
+		tmp << entry << ".tmp" << getpid() << "_" << std::hash<thread::id>()(this_thread::get_id());
+		if (mkdir(tmp.str().c_str(), 0755) != 0) return;
+		bool ok = writeFile(tmp.str() + "/meta", meta);
+		for (int i = 0; ok && i < suffixes().size(); i++)
+			ok = copyFile(name0 + suffixes()[i], tmp.str() + "/" + suffixes()[i]);
+		// another compilation of the same text may have been first
+		if (ok && rename(tmp.str().c_str(), entry.c_str()) == 0) return;
+		for (int i = 0; i < suffixes().size(); i++) unlink((tmp.str() + "/" + suffixes()[i]).c_str());
+		unlink((tmp.str() + "/meta").c_str());
+		rmdir(tmp.str().c_str());
+	}
+
+	static bool readFile(const string & name, string & text) {
+		ifstream in(name, ios::in | ios::binary);
+		if (!in) return false;
+		stringstream buffer;
+		buffer << in.rdbuf();
+		text = buffer.str();
+		return true;
+	}
+
+private:
+	string dir;
+
+	static bool writeFile(const string & name, const string & text) {
+		ofstream out(name, ios::out | ios::binary);
+		out << text;
+		return out.good();
+	}
+
+	static bool copyFile(const string & from, const string & to) {
+		ifstream in(from, ios::in | ios::binary);
+		if (!in) return false;
+		ofstream out(to, ios::out | ios::binary);
+		// streaming an empty buffer counts as a failure
+		if (in.peek() != ifstream::traits_type::eof()) out << in.rdbuf();
+		return out.good();
+	}
+};
+
+#endif
@@ -0,0 +1,156 @@
+#ifndef _COMPILE_PROTOCOL_H_
+#define _COMPILE_PROTOCOL_H_
+
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <utility>
+#include <sstream>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+using namespace std;
+
+#define DEFAULT_SOCKET "/tmp/rule_compiler.sock"
+
+// named fields, a name may occur more than once
+typedef vector<pair<string, string> > Message;
+
+/**
+ * Messages between the compile server and its clients over a Unix domain
+ * socket. A message is a list of fields, each a line "name length" followed
+ * by length bytes of value, and ends with the line "end 0". One request and
+ * one response per connection.
+ */
+class CompileProtocol {
+public:
+	// larger messages are refused, so a broken or hostile peer cannot exhaust the memory
+	static const size_t maxFieldLength = 64 << 20;
+	static const int maxFields = 64;
+
+	static bool send(int fd, const Message & message) {
+		stringstream out;
+		for (int i = 0; i < message.size(); i++)
+			out << message[i].first << " " << message[i].second.size() << "\n" << message[i].second;
+		out << "end 0\n";
+		string data = out.str();
+		for (size_t done = 0; done < data.size(); ) {
+			// a client that went away must not take the server with it
+			ssize_t n = ::send(fd, data.data() + done, data.size() - done, MSG_NOSIGNAL);
+			if (n <= 0) return false;
+			done += n;
+		}
+		return true;
+	}
+
+	/**
+	 * False if the connection ended or timed out before the end of the
+	 * message, or if the message was refused. Then refused, if given, tells
+	 * why it was refused and stays empty for a connection that ended.
+	 */
+	static bool receive(int fd, Message & message, string * refused = NULL) {
+		message.clear();
+		if (refused) refused->clear();
+		while (true) {
+			string header;
+			char c;
+			while (true) {
+				if (read(fd, &c, 1) != 1) return false;
+				if (c == '\n') break;
+				if (header.size() >= 64) return refuse(refused, "a field header longer than 64 bytes");
+				header.push_back(c);
+			}
+			size_t space = header.find(' ');
+			if (space == string::npos || header.find_first_not_of("0123456789", space + 1) != string::npos)
+				return refuse(refused, "the malformed field header \"" + header + "\"");
+			string name = header.substr(0, space);
+			size_t length = strtoul(header.c_str() + space + 1, NULL, 10);
+			if (name == "end") return true;
+			if (length > maxFieldLength) {
+				stringstream why;
+				why << "the field " << name << " of " << length << " bytes, more than the " << maxFieldLength << " allowed";
+				return refuse(refused, why.str());
+			}
+			if (message.size() >= maxFields) return refuse(refused, "more fields than the 64 allowed");
+			string value(length, '\0');
+			for (size_t done = 0; done < length; ) {
+				ssize_t n = read(fd, &value[done], length - done);
+				if (n <= 0) return false;
+				done += n;
+			}
+			message.push_back(make_pair(name, value));
+		}
+	}
+
+	// the value of the first field name, "" if there is none
+	static string get(const Message & message, const string & name) {
+		for (int i = 0; i < message.size(); i++)
+			if (message[i].first == name) return message[i].second;
+		return "";
+	}
+
+	static bool has(const Message & message, const string & name) {
+		for (int i = 0; i < message.size(); i++)
+			if (message[i].first == name) return true;
+		return false;
+	}
+
+	// a connected socket, -1 if there is no server at path
+	static int connectTo(const string & path) {
+		sockaddr_un address;
+		if (!setPath(address, path)) return -1;
+		int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd < 0) return -1;
+		if (connect(fd, (sockaddr *)&address, sizeof(address)) != 0) {
+			close(fd);
+			return -1;
+		}
+		return fd;
+	}
+
+	/**
+	 * A listening socket at path, -1 if another server is listening there or
+	 * path is something other than a socket. A socket left behind is replaced.
+	 */
+	static int listenOn(const string & path) {
+		sockaddr_un address;
+		if (!setPath(address, path)) return -1;
+		struct stat info;
+		bool exists = lstat(path.c_str(), &info) == 0;
+		if (exists && !S_ISSOCK(info.st_mode)) return -1;
+		if (exists) {
+			int running = connectTo(path);
+			if (running >= 0) {
+				close(running);
+				return -1;
+			}
+			unlink(path.c_str());
+		}
+		int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd < 0) return -1;
+		if (bind(fd, (sockaddr *)&address, sizeof(address)) != 0 || listen(fd, 16) != 0) {
+			close(fd);
+			return -1;
+		}
+		return fd;
+	}
+
+private:
+	static bool refuse(string * refused, const string & why) {
+		if (refused) *refused = why;
+		return false;
+	}
+
+	static bool setPath(sockaddr_un & address, const string & path) {
+		memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		if (path.size() >= sizeof(address.sun_path)) return false;
+		strcpy(address.sun_path, path.c_str());
+		return true;
+	}
+};
+
+#endif
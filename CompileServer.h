@@ -0,0 +1,176 @@
+#ifndef _COMPILE_SERVER_H_
+#define _COMPILE_SERVER_H_
+
+#include <cstdlib>
+#include <csignal>
+#include <string>
+#include <map>
+#include <sstream>
+#include <exception>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include "Compiler.h"
+#include "CompileCache.h"
+#include "CompileProtocol.h"
+
+using namespace std;
+
+/**
+ * Compiles rule text sent over a Unix domain socket, for editors and
+ * builds that would otherwise start a process per file. The process, the
+ * cache directory and the responses to recent requests stay warm between
+ * requests. The string and symbol tables do not: identifiers are numbered
+ * in the order they are met and the outputs depend on that numbering.
+ *
+ * request:  name, text, and optionally instrument, stats, profile (a path
+ *           the server can read) or shutdown
+ * response: status ("successful" or "failed"), log, and one field per
+ *           output named by its suffix (".zac", "_analysis.txt", ...); an
+ *           output over CompileProtocol::maxFieldLength fails the response
+ *           with a log that says so
+ *
+ * Requests are served one after the other. A client gets a few seconds to
+ * send its request and take the response, so one that hangs does not block
+ * the others for long. SIGINT and SIGTERM stop the server like a shutdown
+ * request, removing its socket and directory.
+ */
+class CompileServer {
+public:
+	CompileServer(const CompileOptions & options) : options(options) { }
+
+	// serves one request after the other until a shutdown request or signal
+	bool serve(const string & path) {
+		int listener = CompileProtocol::listenOn(path);
+		if (listener < 0) {
+			error << "cannot listen on " << path << ", another server is there or it is not a socket" << endl;
+			return false;
+		}
+		char dir[] = "/tmp/rule_compiler.XXXXXX";
+		if (!mkdtemp(dir)) {
+			error << "cannot create a directory for the outputs" << endl;
+			close(listener);
+			unlink(path.c_str());
+			return false;
+		}
+		workDir = dir;
+
+		struct sigaction stop, oldInt, oldTerm;
+		memset(&stop, 0, sizeof(stop));
+		stop.sa_handler = requestStop;
+		sigemptyset(&stop.sa_mask);
+		stopRequested() = 0;
+		sigaction(SIGINT, &stop, &oldInt);
+		sigaction(SIGTERM, &stop, &oldTerm);
+
+		bool running = true;
+		while (running && !stopRequested()) {
+			// wakes up now and then to see whether a signal asked to stop
+			pollfd waiting = {listener, POLLIN, 0};
+			if (poll(&waiting, 1, 500) <= 0) continue;
+			int fd = accept(listener, NULL, NULL);
+			if (fd < 0) continue;
+			timeval timeout = {clientTimeout, 0};
+			setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+			setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+			Message request;
+			if (CompileProtocol::receive(fd, request)) {
+				running = !CompileProtocol::has(request, "shutdown");
+				CompileProtocol::send(fd, running ? respond(request) : Message());
+			}
+			close(fd);
+		}
+
+		sigaction(SIGINT, &oldInt, NULL);
+		sigaction(SIGTERM, &oldTerm, NULL);
+		close(listener);
+		unlink(path.c_str());
+		rmdir(dir);
+		return true;
+	}
+
+	string getError() {
+		return error.str();
+	}
+
+private:
+	// seconds a client has for each read and write
+	static const int clientTimeout = 2;
+
+	CompileOptions options;
+	string workDir;
+	stringstream error;
+	// responses by the hash of their request
+	map<string, Message> recent;
+
+	Message respond(const Message & request) {
+		string name = CompileProtocol::get(request, "name"), text = CompileProtocol::get(request, "text");
+		CompileOptions requestOptions = options;
+		requestOptions.instrument = CompileProtocol::has(request, "instrument");
+		requestOptions.stats = CompileProtocol::has(request, "stats");
+		requestOptions.profileName = CompileProtocol::get(request, "profile");
+		requestOptions.outputDir = workDir;
+
+		// a profile can change under the same name, and stats are measured anew
+		bool remember = requestOptions.profileName.empty() && !requestOptions.stats;
+		string key;
+		if (remember) {
+			unsigned long long h = CompileCache::hash(name, CompileCache::hash(requestOptions.instrument ? "instrument" : ""));
+			key = CompileCache::hex(CompileCache::hash(CompileCache::significant(text), h));
+			map<string, Message>::iterator it = recent.find(key);
+			if (it != recent.end()) return it->second;
+		}
+
+		Compiler compiler(requestOptions);
+		string name0 = compiler.outputName(name);
+		Message response;
+		// whatever one request runs into, the server goes on with the next
+		try {
+			CompileResult result = compiler.compileText(name, text);
+			response.push_back(make_pair("status", result.succeeded() ? "successful" : "failed"));
+			stringstream log;
+			result.writeLog(log);
+			response.push_back(make_pair("log", log.str()));
+			for (int i = 0; i < CompileCache::suffixes().size(); i++) {
+				string content;
+				if (CompileCache::readFile(name0 + CompileCache::suffixes()[i], content))
+					response.push_back(make_pair(CompileCache::suffixes()[i], content));
+			}
+		} catch (const exception & e) {
+			response.clear();
+			response.push_back(make_pair("status", "failed"));
+			response.push_back(make_pair("log", "parsing file " + name + "\n\ninternal error: " + e.what() + "\n"));
+			remember = false;
+		}
+		for (int i = 0; i < CompileCache::suffixes().size(); i++) unlink((name0 + CompileCache::suffixes()[i]).c_str());
+		// the client refuses larger fields, it is told why instead
+		for (int i = 0; i < response.size(); i++) {
+			if (response[i].second.size() <= CompileProtocol::maxFieldLength) continue;
+			stringstream log;
+			log << "parsing file " << name << endl << endl << "the output " << response[i].first << " has "
+				<< response[i].second.size() << " bytes, a response can carry at most " << CompileProtocol::maxFieldLength
+				<< " per output, compile the file with main instead" << endl;
+			response.clear();
+			response.push_back(make_pair("status", "failed"));
+			response.push_back(make_pair("log", log.str()));
+			break;
+		}
+		if (remember) {
+			if (recent.size() >= 64) recent.clear();
+			recent[key] = response;
+		}
+		return response;
+	}
+
+	static volatile sig_atomic_t & stopRequested() {
+		static volatile sig_atomic_t stop = 0;
+		return stop;
+	}
+
+	static void requestStop(int) {
+		stopRequested() = 1;
+	}
+};
+
+#endif
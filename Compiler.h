@@ -0,0 +1,272 @@
+#ifndef _COMPILER_H_
+#define _COMPILER_H_
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "counted_ptr.h"
+#include "Arena.h"
+#include "Lexer.h"
+#include "StringTable.h"
+#include "SymbolTable.h"
+#include "FrontEnd.h"
+#include "BasicData.h"
+#include "SemanticsAnalyser.h"
+#include "ZasimCodeGenerator.h"
+#include "FunctionAnalyser.h"
+#include "BlockProfile.h"
+#include "Instrumentation.h"
+#include "CompileCache.h"
+
+// part of the cache key, to be raised whenever the generated files change
+#define COMPILER_VERSION "1"
+
+using namespace std;
+
+struct CompileOptions {
+	CompileOptions() : instrument(false), stats(false), streaming(false), minParallelBlocks(16) { }
+
+	bool instrument;
+	bool stats;               // phase times, memory and counters in the log
+	bool streaming;           // read the file line by line instead of mapping it as a whole
+	string profileName;       // empty for none
+	string cacheDir;          // see CompileCache, empty for none
+	string outputDir;         // where the outputs go, empty for next to the rule file
+	int minParallelBlocks;    // see FrontEnd, INT_MAX parses every file on one thread
+};
+
+// what happened to one file, the contents of its _log.txt
+struct CompileResult {
+	CompileResult() : profileRead(true), parsed(false), analysed(false), functionAnalysed(false), generated(false), cached(false), duplicates(0), showStats(false) { }
+
+	string name;
+	string profileName;
+	bool profileRead;
+	bool parsed, analysed, functionAnalysed, generated;
+	bool cached;              // the outputs were copied from the cache
+	int duplicates;
+	string parseError, semanticsError, functionError, generatorError;
+	Instrumentation stats;
+	bool showStats;
+
+	bool succeeded() const {
+		return generated;
+	}
+
+	// the first stage that failed, "" if there is none
+	string failedStage() const {
+		if (!parsed) return "parsing";
+		if (!analysed) return "semantics analysis";
+		if (!functionAnalysed) return "function analysis";
+		if (!generated) return "code generator";
+		return "";
+	}
+
+	void writeLog(ostream & outStream) const {
+		outStream << "parsing file " << name << endl << endl;
+		if (!profileName.empty())
+			outStream << "block profile:       " << (profileRead ? profileName : "could not read " + profileName) << endl;
+		if (cached)
+			outStream << "cache:               hit" << endl;
+
+		outStream << "parsing:             " << (parsed? "successful": "failure") << endl;
+		if (duplicates > 0)
+			outStream << "duplicate blocks:    " << duplicates << " removed" << endl;
+		outStream << "semantics analysis:  " << (analysed? "successful": "failure") << endl;
+		outStream << "function analysis:   " << (functionAnalysed? "successful": "failure") << endl;
+		outStream << "code generator:      " << (generated? "successful": "failure") << endl << endl;
+
+		outStream << "parse error:         " << parseError     << endl;
+		outStream << "semantics error:     " << semanticsError << endl;
+		outStream << "function error:      " << functionError  << endl;
+		outStream << "generator error:     " << generatorError << endl << endl;
+
+		if (showStats) stats.writeTable(outStream);
+	}
+};
+
+/**
+ * Runs all stages for one rule file and writes its .zac, _analysis.txt,
+ * .table and .coverage next to it. Every table and the parse tree belong to
+ * the call, so one Compiler can be used for any number of files, also from
+ * several threads at once. With a cache directory a file whose text was
+ * compiled before gets its outputs from there without being lexed.
+ */
+class Compiler {
+public:
+	Compiler(const CompileOptions & options) : options(options) { }
+
+	CompileResult compile(const string & name) {
+		return compile(name, 0);
+	}
+
+	// compiles text as the contents of the file name, which need not exist
+	CompileResult compileText(const string & name, const string & text) {
+		return compile(name, &text);
+	}
+
+	// the name without its extension, the outputs are named after it
+	static string baseName(const string & name) {
+		size_t slash = name.find_last_of('/');
+		size_t dot = name.find_first_of('.', (slash == string::npos) ? 0 : slash + 1);
+		return name.substr(0, dot);
+	}
+
+	// the name the outputs of the file name get, outputDir replaces its directory
+	string outputName(const string & name) const {
+		if (options.outputDir.empty()) return baseName(name);
+		string name0 = baseName(name);
+		size_t slash = name0.find_last_of('/');
+		return options.outputDir + "/" + ((slash == string::npos) ? name0 : name0.substr(slash + 1));
+	}
+
+private:
+	CompileOptions options;
+
+	CompileResult compile(const string & name, const string * text) {
+		if (options.cacheDir.empty()) return run(name, text);
+		CompileResult result;
+		result.name = name;
+		result.profileName = options.profileName;
+		result.showStats = options.stats;
+		result.stats.begin("cache lookup");
+		string key;
+		bool keyed = cacheKey(name, text, key, result.profileRead);
+		string meta;
+		CompileCache cache(options.cacheDir);
+		if (keyed && cache.fetch(key, outputName(name), meta) && readMeta(meta, result)) {
+			result.stats.end();
+			result.stats.count("cache hits", 1);
+			result.cached = true;
+			return result;
+		}
+		result.stats.end();
+
+		CompileResult compiled = run(name, text);
+		compiled.stats.count("cache misses", 1);
+		// a failed compilation leaves some of the outputs unwritten, only complete sets are kept
+		if (keyed && compiled.succeeded()) cache.store(key, outputName(name), writeMeta(compiled));
+		return compiled;
+	}
+
+	CompileResult run(const string & name, const string * text) {
+		CompileResult result;
+		result.name = name;
+		result.profileName = options.profileName;
+		result.showStats = options.stats;
+		Instrumentation & stats = result.stats;
+		string name0 = outputName(name);
+
+		// owns the parse tree, declared first so it goes last
+		Arena arena;
+		StringTable strTable;
+		SymbolTable varTable;
+
+		// the lexer maps the file and finds its pictures here, the tokens are made while parsing
+		stats.begin("lexing");
+		bool streamed = options.streaming && !text;
+		ifstream input;
+		if (streamed) input.open(name, ios::in | ios::binary);
+		counted_ptr<Lexer> lexer(text ? new Lexer(text->data(), text->size(), strTable)
+			: streamed ? new Lexer(input, strTable) : new Lexer(name, strTable));
+		stats.end();
+		FrontEnd parser(*lexer, strTable, arena, options.minParallelBlocks);
+		SemanticsAnalyser analyser(varTable);
+		FunctionAnalyser fana(strTable, varTable, name0);
+		ZasimCodeGenerator cgen(strTable, varTable, name0);
+		cgen.setInstrument(options.instrument);
+		cgen.setProfileName(baseName(name) + ".profile");
+		BlockProfile profile;
+		result.profileRead = options.profileName.empty() || profile.read(options.profileName);
+
+		CellFile file;
+		stats.begin("parsing");
+		result.parsed = parser.parseFile(file);
+		stats.end();
+		if (result.parsed) {
+			stats.begin("semantics");
+			result.analysed = analyser.analyseProgram(file);
+			stats.end();
+		}
+		if (result.analysed) {
+			stats.begin("function analysis");
+			result.functionAnalysed = fana.analyseFunction(file);
+			stats.end();
+		}
+		if (result.functionAnalysed) {
+			stats.begin("code generation");
+			if (profile.empty())
+				for (int i = 0; i < file.blocks.size(); i++) profile.addHits(i, fana.blockMatched[i]);
+			vector<int> order = profile.order(file.blocks.size(), fana.overlappingBlocks);
+			cgen.setCoverage(fana.blockMatched);
+			result.generated = cgen.generateCode(file, fana.setLists, order);
+			stats.end();
+		}
+
+		if (!streamed) stats.count("lines", lexer->lineCount());
+		stats.count("identifiers", strTable.size());
+		stats.count("blocks", file.blocks.size());
+		stats.count("duplicate blocks", parser.getDuplicates());
+		stats.count("set nodes", parser.getNodes().getSetCount());
+		stats.count("term nodes", parser.getNodes().getTermCount());
+		if (result.analysed) {
+			stats.count("instances", fana.instancesTested);
+			stats.count("blocks tested", fana.blocksTested);
+		}
+
+		result.duplicates = parser.getDuplicates();
+		result.parseError = parser.getError();
+		result.semanticsError = analyser.getError();
+		result.functionError = fana.getError();
+		result.generatorError = cgen.getError();
+		return result;
+	}
+
+	/**
+	 * Hash of the rule text and of whatever else goes into the outputs: the
+	 * compiler version, the options that change them and the block profile.
+	 * False if the rule file cannot be read.
+	 */
+	bool cacheKey(const string & name, const string * text, string & key, bool & profileRead) {
+		string fileText, profileText;
+		if (!text && !CompileCache::readFile(name, fileText)) return false;
+		// each part is hashed with its length, see CompileCache::hash
+		unsigned long long h = CompileCache::hash(COMPILER_VERSION);
+		h = CompileCache::hash(options.instrument ? "instrument" : "", h);
+		// the generated counters write to a file named after the rule file
+		if (options.instrument) h = CompileCache::hash(baseName(name), h);
+		if (!options.profileName.empty()) {
+			profileRead = CompileCache::readFile(options.profileName, profileText);
+			h = CompileCache::hash(profileRead ? "profile" : "no profile", h);
+			h = CompileCache::hash(profileText, h);
+		}
+		key = CompileCache::hex(CompileCache::hash(CompileCache::significant(text ? *text : fileText), h));
+		return true;
+	}
+
+	// the parts of a successful result that are not implied by its success
+	static string writeMeta(const CompileResult & result) {
+		stringstream meta;
+		meta << result.profileRead << " " << result.duplicates << endl;
+		const string * errors[] = {&result.parseError, &result.semanticsError, &result.functionError, &result.generatorError};
+		for (int i = 0; i < 4; i++) meta << errors[i]->size() << endl << *errors[i];
+		return meta.str();
+	}
+
+	static bool readMeta(const string & text, CompileResult & result) {
+		stringstream meta(text);
+		meta >> result.profileRead >> result.duplicates;
+		string * errors[] = {&result.parseError, &result.semanticsError, &result.functionError, &result.generatorError};
+		for (int i = 0; i < 4; i++) {
+			size_t length;
+			if (!(meta >> length) || meta.get() != '\n') return false;
+			errors[i]->resize(length);
+			if (length > 0 && !meta.read(&(*errors[i])[0], length)) return false;
+		}
+		result.parsed = result.analysed = result.functionAnalysed = result.generated = true;
+		return true;
+	}
+};
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef _FNV_H_
+#define _FNV_H_
+
+/**
+ * FNV-1a, one step at a time, so each table decides what goes into its
+ * hash: the string table bytes, the node table the ints of a key and the
+ * compile cache the text without blanks at the end of lines.
+ */
+namespace Fnv {
+	const unsigned int offset32 = 2166136261u;
+	const unsigned long long offset64 = 14695981039346656037ull;
+
+	inline unsigned int step32(unsigned int h, unsigned int value) {
+		return (h ^ value) * 16777619u;
+	}
+
+	inline unsigned long long step64(unsigned long long h, unsigned char c) {
+		return (h ^ c) * 1099511628211ull;
+	}
+}
+
+#endif
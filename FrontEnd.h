@@ -0,0 +1,135 @@
+#ifndef _FRONT_END_H_
+#define _FRONT_END_H_
+
+#include <string>
+#include <sstream>
+#include <vector>
+#include <thread>
+#include <unordered_set>
+#include "counted_ptr.h"
+#include "StringTable.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "BasicData.h"
+#include "Arena.h"
+#include "NodeTable.h"
+#include "WorkerPool.h"
+
+using namespace std;
+
+/**
+ * Lexes and parses a rule file. Blocks are independent until the semantics
+ * analysis, so a file with many of them is split at its '___' lines and
+ * the block ranges are lexed and parsed on several threads. Identifiers are
+ * interned into the shared StringTable between the two passes, in the order
+ * of the file, so the result is the same as that of a serial Parser.
+ * Finally equal sets and terms of the whole file are merged into shared
+ * nodes by a NodeTable, and blocks equal to an earlier one (a symmetric
+ * block turned onto itself) are dropped.
+ */
+class FrontEnd {
+public:
+	FrontEnd(Lexer & lexer, StringTable & strTbl, Arena & arena, int minParallelBlocks = 16)
+		: lexer(lexer), strTbl(strTbl), arena(arena), minParallelBlocks(minParallelBlocks), duplicates(0) { }
+
+	bool parseFile(CellFile & file) {
+		if (!parse(file)) return false;
+		nodes.shareAll(file);
+		removeDuplicates(file);
+		return true;
+	}
+
+	// the number of blocks parseFile dropped as equal to an earlier one
+	int getDuplicates() {
+		return duplicates;
+	}
+
+	string getError() {
+		return error.str();
+	}
+
+	NodeTable & getNodes() {
+		return nodes;
+	}
+
+private:
+	Lexer & lexer;
+	StringTable & strTbl;
+	Arena & arena;
+	int minParallelBlocks;
+	stringstream error;
+	NodeTable nodes;
+	int duplicates;
+
+	// the first of equal blocks is kept, it is the one that fires
+	void removeDuplicates(CellFile & file) {
+		unordered_set<vector<int>, NodeTable::KeyHash> seen;
+		vector<Block> unique;
+		for (int i = 0; i < file.blocks.size(); i++) {
+			if (!seen.insert(nodes.key(file.blocks[i])).second) continue;
+			file.blocks[i].setBlockIdent(unique.size());
+			unique.push_back(file.blocks[i]);
+		}
+		duplicates = file.blocks.size() - unique.size();
+		file.blocks.swap(unique);
+	}
+
+	bool parse(CellFile & file) {
+		if (lexer.isStreaming()) return parseSerial(file);
+		vector<int> separators = lexer.separatorLines();
+		int threads = thread::hardware_concurrency();
+		if (threads < 2 || (int)separators.size() < minParallelBlocks) return parseSerial(file);
+
+		// the head is parsed first, its identifiers get the lowest numbers
+		Lexer headLexer(lexer, 0, separators[0], strTbl);
+		Parser headParser(headLexer, strTbl, arena);
+		if (!headParser.parseHeader(file) || !headParser.atEnd()) return parseSerial(file);
+		error << headParser.getError();
+
+		int n = separators.size();
+		vector<counted_ptr<StringTable> > tables(n);
+		vector<counted_ptr<Lexer> > lexers(n);
+		for (int i = 0; i < n; i++) {
+			int last = (i + 1 < n) ? separators[i+1] : lexer.lineCount() - 1;
+			tables[i] = counted_ptr<StringTable>(new StringTable());
+			lexers[i] = counted_ptr<Lexer>(new Lexer(lexer, separators[i] + 1, last, *tables[i]));
+		}
+		WorkerPool::run(n, threads, [&](int i) { lexers[i]->lexAll(); });
+
+		for (int i = 0; i < n; i++) lexers[i]->internInto(strTbl);
+
+		int cellX(file.head.getCell()->getWidth()), cellY(file.head.getCell()->getHeight());
+		vector<counted_ptr<Arena> > arenas(n);
+		vector<counted_ptr<Parser> > parsers(n);
+		vector<vector<Block> > blocks(n);
+		vector<char> ok(n, false);
+		for (int i = 0; i < n; i++) {
+			arenas[i] = counted_ptr<Arena>(new Arena());
+			parsers[i] = counted_ptr<Parser>(new Parser(*lexers[i], strTbl, *arenas[i]));
+			parsers[i]->setCellSize(cellX, cellY);
+		}
+		WorkerPool::run(n, threads, [&](int i) { ok[i] = parsers[i]->parseBlocks(blocks[i]); });
+
+		for (int i = 0; i < n; i++) arena.splice(*arenas[i]);
+		for (int i = 0; i < n; i++) {
+			error << parsers[i]->getError();
+			if (!ok[i]) return false;
+			for (int j = 0; j < blocks[i].size(); j++) {
+				blocks[i][j].setBlockIdent(file.blocks.size());
+				file.blocks.push_back(blocks[i][j]);
+			}
+		}
+		return true;
+	}
+
+	bool parseSerial(CellFile & file) {
+		error.str("");
+		file = CellFile();
+		Parser parser(lexer, strTbl, arena);
+		bool result = parser.parseFile(file);
+		error << parser.getError();
+		return result;
+	}
+};
+
+#endif
@@ -12,32 +12,31 @@
 #include "Lexer.h"
 #include "Set.h"
 #include "BasicData.h"
-#include "Variable.h"
-
-
-bool cell_comp (CellStatement cs1, CellStatement cs2) {
-	if (cs1.getType() < cs2.getType()) return true;
-	else if (cs1.getType() > cs2.getType()) return false;
-	else return cs1.getIdentNumber() < cs2.getIdentNumber();
-}
+#include "SymbolTable.h"
+#include "ValueSet.h"
 
 
 class FunctionAnalyser {
 public:
-	FunctionAnalyser(StringTable & strTable, map<int, counted_ptr<Variable>> & varTable, string name) 
-		: varTable(varTable), strTable(strTable), posSet(counted_ptr<Set>(new Set())), setLists(counted_ptr<vector<CellStatement>>()), instance(-1), varUsed(false) {
+	FunctionAnalyser(StringTable & strTable, SymbolTable & varTable, string name) 
+		: varTable(varTable), strTable(strTable), posSet(Set::empty()), setLists(counted_ptr<vector<CellStatement>>()), instance(-1), varUsed(false) {
 		outStream.open(name + "_analysis.txt");
 		tableStream.open(name + ".table");
+		coverageStream.open(name + ".coverage");
 	}
 
 	~FunctionAnalyser() {
 		outStream.close();
 		tableStream.close();
+		coverageStream.close();
 	}
 
 	bool analyseFunction(CellFile & program) {
 		finished = false;
 		seriousError = false;
+		blockMatched.assign(program.blocks.size(), 0);
+		blockShadowed.assign(program.blocks.size(), 0);
+		instancesTested = blocksTested = 0;
 
 		prepare(program);
 		while (!finished) {
@@ -49,6 +48,7 @@ public:
 			outStream << endl;
 			generateInstance(); // get next instance
 		}
+		printCoverage(program);
 		return !seriousError;
 	}
 
@@ -58,27 +58,50 @@ public:
 
 	Picture<counted_ptr<vector<CellStatement>>> setLists;
 
+	/**
+	 * Pairs of blocks (earlier, later) triggered together by at least one instance.
+	 */
+	set<pair<int, int>> overlappingBlocks;
+
+	/**
+	 * Per block the number of instances it fires for (matched) and the number
+	 * of instances it fits but an earlier block fires instead (shadowed).
+	 */
+	vector<unsigned long long> blockMatched, blockShadowed;
+
+	// instances enumerated and blocks tried on them
+	unsigned long long instancesTested, blocksTested;
+
 private:
-	map<int, counted_ptr<Variable>> & varTable;
+	SymbolTable & varTable;
 	StringTable & strTable;
 	stringstream error;
-	ofstream outStream, tableStream;
+	ofstream outStream, tableStream, coverageStream;
 
 	int cellX, cellY;
-	Picture<counted_ptr<Set>> posSet;
+	Picture<arena_ptr<Set>> posSet;
+	// by set node id, the ids are dense; grown as ids come up
+	vector<ValueSet> setValues;
+	vector<bool> setValuesKnown;
+	vector<signed char> setLocal; // -1 not yet known
 	
 	int mainX, mainY;
 	Picture<int> instance;
 	bool finished, seriousError, doTable, vonNeumann;
-	Picture<bool> varUsed;
+	FixedPicture<bool, 3, 3> varUsed;
+
+	// blocks worth testing per value of the instance at (dispatchX, dispatchY)
+	int dispatchX, dispatchY;
+	vector<vector<int>> dispatch;
 
 	void generateInstance() {
 		// change instance
 		for (int x = 0; x < instance.getWidth(); x++)
 			for (int y = 0; y < instance.getHeight(); y++) {
-				if (instance.get(x,y) >= 0) {
-					instance.set(x,y, instance.get(x,y) + 1);
-					if (instance.get(x,y) >= setLists.get(modX(x),modY(y))->size()) instance.set(x,y,0);
+				int & value = instance.row(y)[x];
+				if (value >= 0) {
+					value++;
+					if (value >= setLists.get(modX(x),modY(y))->size()) value = 0;
 					else return;
 				}
 			}
@@ -91,7 +114,7 @@ private:
 		cellY = program.head.getCell()->getHeight();
 		posSet.setSize(cellX, cellY);
 
-		counted_ptr<Picture<counted_ptr<CellStatement>>> pic = program.head.getCell();
+		arena_ptr<Picture<arena_ptr<CellStatement>>> pic = program.head.getCell();
 		for (int i = 0; i < cellX; i++)
 			for (int j = 0; j < cellY; j++) {
 				if (pic->get(i,j)->getType() != EMPTY) {
@@ -105,13 +128,17 @@ private:
 			for (int j = 0; j < cellY; j++) {
 				if (pic->get(i,j)->getType() != EMPTY) {
 					setLists.set(i, j, counted_ptr<vector<CellStatement>>(new vector<CellStatement>()));
-					bool(*cell_pt)(CellStatement, CellStatement) = cell_comp;
-					set<CellStatement, bool (*) (CellStatement, CellStatement)> to(cell_pt);
-					set<CellStatement, bool (*) (CellStatement, CellStatement)>::iterator it;
+					ValueSet to;
 					prepareSetList(posSet.get(i,j), to);
-					for (it = to.begin(); it != to.end(); it++) {
-						setLists.get(i,j)->push_back(*it);
-					}
+					// numbers before identifiers, both ascending
+					vector<CellStatement> & list = *setLists.get(i,j);
+					list.reserve(to.size());
+					const vector<ValueSet::Interval> & intervals = to.getIntervals();
+					for (int k = 0; k < intervals.size(); k++)
+						for (long n = intervals[k].first; n <= intervals[k].last; n++)
+							list.push_back(CellStatement(CELL_NUMBER, n, arena_ptr<Set>()));
+					for (int k = 0; k < to.getIdentifiers().size(); k++)
+						list.push_back(CellStatement(CELL_IDENTIFIER, to.getIdentifiers()[k], arena_ptr<Set>()));
 					if (setLists.get(i,j)->size() == 0) {
 						seriousError = true;
 						error << "Error: there is an empty set inside the header" << endl;
@@ -128,8 +155,8 @@ private:
 		for (int i = 0; i < program.blocks.size(); i++) {
 			left = max(left,	program.blocks[i].getX());
 			up   = max(up,		program.blocks[i].getY());
-			right= max(right,	program.blocks[i].getLeft()->getWidth()  - program.blocks[i].getX());
-			down = max(down,	program.blocks[i].getLeft()->getHeight() - program.blocks[i].getY());
+			right= max(right,	program.blocks[i].getLeft().getWidth()  - program.blocks[i].getX());
+			down = max(down,	program.blocks[i].getLeft().getHeight() - program.blocks[i].getY());
 		}
 		
 		instance.setSize(left+right, up+down);
@@ -138,26 +165,84 @@ private:
 		mainY = up;
 
 		for (int i = 0; i < program.blocks.size(); i++) {
-			pic = program.blocks[i].getLeft();
-			for (int x = 0; x < pic->getWidth(); x++)
-				for (int y = 0; y < pic->getHeight(); y++) {
-					if (pic->get(x,y)->getType() != EMPTY) instance.set(x - program.blocks[i].getX() + mainX, y - program.blocks[i].getY() + mainY, 0);
+			const SymmetryView & left = program.blocks[i].getLeft();
+			for (int x = 0; x < left.getWidth(); x++)
+				for (int y = 0; y < left.getHeight(); y++) {
+					if (left.get(x,y)->getType() != EMPTY) instance.set(x - program.blocks[i].getX() + mainX, y - program.blocks[i].getY() + mainY, 0);
 				}
 		}
 
 		// Could be needed if empty squares in solution
 		for (int i = 0; i < program.blocks.size(); i++) {
-			counted_ptr<Picture<counted_ptr<CellStatement>>> h = program.head.getCell();
+			arena_ptr<Picture<arena_ptr<CellStatement>>> h = program.head.getCell();
 			pic = program.blocks[i].getRight();
 			for (int x = 0; x < cellX; x++)
 				for (int y = 0; y < cellY; y++) {
 					if (pic->get(x,y)->getType() == EMPTY && h->get(x,y)->getType() != EMPTY) instance.set(x+mainX, y+mainY, 0); 	
 				}
 		}
+		prepareDispatch(program);
 		prepareOutput(program);
 		if (doTable) prepareTableVariables();
 	}
 
+	/**
+	 * Picks the instance position pinned to a single value by the most blocks
+	 * and lists for each of its values the blocks that can possibly fire,
+	 * so testInstance does not have to try all blocks for every instance.
+	 */
+	void prepareDispatch(CellFile & program) {
+		map<pair<int, int>, vector<pair<int, int>>> pins; // position -> (block, value index)
+		for (int i = 0; i < program.blocks.size(); i++) {
+			Block & block = program.blocks[i];
+			const SymmetryView & pic = block.getLeft();
+			for (int x = 0; x < pic.getWidth(); x++)
+				for (int y = 0; y < pic.getHeight(); y++) {
+					arena_ptr<CellStatement> cell = pic.get(x,y);
+					CellStatementType type;
+					if (cell->getType() == CELL_NUMBER) type = CELL_NUMBER;
+					else if ((cell->getType() == CELL_IDENTIFIER || cell->getType() == IDENTIFIER_IN_SET)
+						&& varTable.is(cell->getIdentNumber(), SET_CONTENT)) type = CELL_IDENTIFIER;
+					else continue;
+
+					int x1 = x - block.getX() + mainX, y1 = y - block.getY() + mainY;
+					vector<CellStatement> & values = *setLists.get(modX(x1), modY(y1));
+					int v = -1;
+					for (int k = 0; k < values.size(); k++)
+						if (values[k].getType() == type && values[k].getIdentNumber() == cell->getIdentNumber()) v = k;
+					pins[make_pair(x1, y1)].push_back(make_pair(i, v));
+				}
+		}
+
+		// the fewer candidates summed over all values the better
+		long best = -1;
+		map<pair<int, int>, vector<pair<int, int>>>::iterator chosen = pins.end();
+		for (map<pair<int, int>, vector<pair<int, int>>>::iterator it = pins.begin(); it != pins.end(); it++) {
+			long n = setLists.get(modX(it->first.first), modY(it->first.second))->size();
+			long cost = n * (program.blocks.size() - it->second.size()) + it->second.size();
+			if (best < 0 || cost < best) {
+				best = cost;
+				chosen = it;
+			}
+		}
+
+		dispatch.clear();
+		if (chosen == pins.end()) {
+			dispatchX = dispatchY = -1;
+			dispatch.push_back(vector<int>());
+			for (int i = 0; i < program.blocks.size(); i++) dispatch[0].push_back(i);
+			return;
+		}
+		dispatchX = chosen->first.first;
+		dispatchY = chosen->first.second;
+		vector<int> pinnedTo(program.blocks.size(), -2);
+		for (int k = 0; k < chosen->second.size(); k++) pinnedTo[chosen->second[k].first] = chosen->second[k].second;
+		dispatch.resize(setLists.get(modX(dispatchX), modY(dispatchY))->size());
+		for (int v = 0; v < dispatch.size(); v++)
+			for (int i = 0; i < program.blocks.size(); i++)
+				if (pinnedTo[i] == -2 || pinnedTo[i] == v) dispatch[v].push_back(i);
+	}
+
 	void prepareOutput(CellFile & program) {
 		//prepare outStream
 		for (int x = 0; x < instance.getWidth(); x++) 
@@ -196,59 +281,85 @@ private:
 
 
 	// has to be tested i am a little causiouss
-	void prepareSetList(counted_ptr<Set> set1, set<CellStatement, bool (*) (CellStatement, CellStatement)> & to) {
+	// the values of set1 are added to 'to'
+	void prepareSetList(arena_ptr<Set> set1, ValueSet & to) {
+		to.unite(valuesOf(set1));
+	}
+
+	// computed once for every shared set node
+	ValueSet valuesOf(arena_ptr<Set> set1) {
+		int id = set1->getNodeId();
+		if (id >= 0 && id < setValuesKnown.size() && setValuesKnown[id]) return setValues[id];
+		ValueSet to;
 		switch (set1->getType()) {
-		case SET_IDENTIFIER:{
-								counted_ptr<Set> set2 = static_cast<VariableSet*>(varTable[static_cast<SetIdentifier*>(set1.get())->getName()].get())->getSet();
-								prepareSetList(set2, to);
+		case SET_IDENTIFIER:	to = valuesOf(varTable.getSet(static_cast<SetIdentifier*>(set1.get())->getName()));
 								break;
-							}
 		case SET_ENUM:		{
 								SetList * setL = static_cast<SetList *>(set1.get());
 								for (int i = 0; i < setL->getNumbers().size(); i++) {
-									to.insert(CellStatement(CELL_NUMBER, setL->getNumbers()[i], counted_ptr<Set>()));
+									to.addNumber(setL->getNumbers()[i]);
 								}
 								for (int i = 0; i < setL->getIdentifiers().size(); i++) {
-									to.insert(CellStatement(CELL_IDENTIFIER, setL->getIdentifiers()[i], counted_ptr<Set>()));
+									to.addIdentifier(setL->getIdentifiers()[i]);
 								}
 								break;
 							}
 		case SET_RANGE:		{
 								SetRange * setR =  static_cast<SetRange*>(set1.get());
-								for (int i = setR->getFirst(); i <= setR->getLast(); i++) {
-									to.insert(CellStatement(CELL_NUMBER, i, counted_ptr<Set>()));
-								}
+								to.addRange(setR->getFirst(), setR->getLast());
 								break;
 							}
 		case SET_STATEMENT:	{
 								SetStatement * setS = static_cast<SetStatement*>(set1.get());
-								prepareSetList(setS->getLeft(), to);
+								// both operands on their own: S = {0,1,2} + ({3} - {1}) is {0,1,2,3},
+								// not ({0,1,2} + {3}) - {1} as when the operands were added to one list
+								to = valuesOf(setS->getLeft());
 								switch(setS->getOp()) {
-								case UNION:				prepareSetList(setS->getRight(), to); break;
-								case INTERSECTION:	{
-														bool(*cell_pt)(CellStatement, CellStatement) = cell_comp;
-														set<CellStatement, bool (*) (CellStatement, CellStatement)> locSet(cell_comp);
-														prepareSetList(setS->getRight(), locSet);
-														set<CellStatement, bool (*) (CellStatement, CellStatement)>::iterator it;
-														for ( it=to.begin() ; it != to.end(); it++ ) {
-															if (!locSet.count(*it)) to.erase(it);
-														}
-														break;
-													}
-								case RELATIVE_COMPLEMENT: 
-													{
-														bool(*cell_pt)(CellStatement, CellStatement) = cell_comp;
-														set<CellStatement, bool (*) (CellStatement, CellStatement)> locSet(cell_comp);
-														prepareSetList(setS->getRight(), locSet);
-														set<CellStatement, bool (*) (CellStatement, CellStatement)>::iterator it;
-														for ( it=locSet.begin() ; it != locSet.end(); it++ ) {
-															if (to.count(*it)) to.erase(*it);
-														}
-														break;
-													}
+								case UNION:					to.unite(valuesOf(setS->getRight())); break;
+								case INTERSECTION:			to.intersect(valuesOf(setS->getRight())); break;
+								case RELATIVE_COMPLEMENT:	to.subtract(valuesOf(setS->getRight())); break;
 								}
+								break;
 							}
+		default: break;
 		}
+		if (id >= 0) {
+			if (id >= setValues.size()) {
+				setValues.resize(id + 1);
+				setValuesKnown.resize(id + 1, false);
+			}
+			setValues[id] = to;
+			setValuesKnown[id] = true;
+		}
+		return to;
+	}
+
+	// whether the set contains a local variable, its members then depend on the instance
+	bool isLocal(arena_ptr<Set> set1) {
+		int id = set1->getNodeId();
+		if (id >= 0 && id < setLocal.size() && setLocal[id] >= 0) return setLocal[id];
+		bool local = false;
+		switch (set1->getType()) {
+		case SET_IDENTIFIER:	local = isLocal(varTable.getSet(static_cast<SetIdentifier*>(set1.get())->getName())); break;
+		case SET_ENUM:		{
+								vector<int> & vec = static_cast<SetList*>(set1.get())->getIdentifiers();
+								for (int i = 0; i < vec.size(); i++) {
+									if (varTable.is(vec[i], VAR_CONTENT)) local = true;
+								}
+								break;
+							}
+		case SET_STATEMENT:	{
+								SetStatement * setS = static_cast<SetStatement*>(set1.get());
+								local = isLocal(setS->getLeft()) || isLocal(setS->getRight());
+								break;
+							}
+		default: break;
+		}
+		if (id >= 0) {
+			if (id >= setLocal.size()) setLocal.resize(id + 1, -1);
+			setLocal[id] = local;
+		}
+		return local;
 	}
 
 	int modX(int x) {
@@ -283,12 +394,20 @@ private:
 	
 	void testInstance(CellFile & file) {
 		vector<int> vec;
-		for (int i = 0; i < file.blocks.size(); i++) {
-			if (testInstanceInBlock(file.blocks[i])) vec.push_back(i);
+		vector<int> & candidates = dispatch[(dispatchX < 0) ? 0 : instance.get(dispatchX, dispatchY)];
+		instancesTested++;
+		blocksTested += candidates.size();
+		for (int i = 0; i < candidates.size(); i++) {
+			if (testInstanceInBlock(file.blocks[candidates[i]])) vec.push_back(candidates[i]);
 		}
 
 		printResult(file, vec);
 
+		for (int i = 0; i < vec.size(); i++)
+			for (int j = i + 1; j < vec.size(); j++) overlappingBlocks.insert(make_pair(vec[i], vec[j]));
+		if (!vec.empty()) blockMatched[vec[0]]++;
+		for (int i = 1; i < vec.size(); i++) blockShadowed[vec[i]]++;
+
 		if (vec.empty()) {
 			error << printInstance() << "Warning: no result" << endl;
 		} else if (vec.size() == 1) {
@@ -325,24 +444,33 @@ private:
 		if (!vec.empty()) testResultLegal(file.blocks[vec[0]]);
 	}
 
+	void printCoverage(CellFile & file) {
+		coverageStream << "block matched shadowed" << endl;
+		for (int i = 0; i < file.blocks.size(); i++) {
+			coverageStream << i << " " << blockMatched[i] << " " << blockShadowed[i] << endl;
+			if (!seriousError && blockMatched[i] == 0)
+				error << "Warning: block " << i << " never fires (shadowed by earlier blocks for " << blockShadowed[i] << " instances)" << endl;
+		}
+	}
+
 	bool testInstanceInBlock(Block & block) {
-		counted_ptr<Picture<counted_ptr<CellStatement>>> pic = block.getLeft();
-		for (int x = 0; x < pic->getWidth(); x++) {
-			int x1 = x - block.getX() + mainX;
-			for (int y = 0; y < pic->getHeight(); y++) {
-				int y1 = y - block.getY() + mainY;
-				counted_ptr<CellStatement> cell = pic->get(x,y);
+		const SymmetryView & pic = block.getLeft();
+		for (int y = 0; y < pic.getHeight(); y++) {
+			int y1 = y - block.getY() + mainY;
+			for (int x = 0; x < pic.getWidth(); x++) {
+				int x1 = x - block.getX() + mainX;
+				const arena_ptr<CellStatement> & cell = pic.get(x,y);
 				switch (cell->getType()) {
 				case EMPTY:				break;
 				case CELL_NUMBER:		if (get(x1,y1).getType() != CELL_NUMBER 
 											|| cell->getIdentNumber() != get(x1,y1).getIdentNumber()) return false;
 										break;
 				case IDENTIFIER_IN_SET:	if (!inSet(get(x1,y1), cell->getSet(), block)) return false;
-				case CELL_IDENTIFIER:	if (varTable[cell->getIdentNumber()]->getType() == SET_CONTENT) {
+				case CELL_IDENTIFIER:	if (varTable.is(cell->getIdentNumber(), SET_CONTENT)) {
 											if (get(x1,y1).getType() != CELL_IDENTIFIER
 												|| cell->getIdentNumber() != get(x1,y1).getIdentNumber()) return false;
-										} else if (varTable[cell->getIdentNumber()]->getType() == VAR_CONTENT) {
-											VariableContent::Koord k = static_cast<VariableContent *>(varTable[cell->getIdentNumber()].get())->getKoord(block.getBlockIdent());
+										} else if (varTable.is(cell->getIdentNumber(), VAR_CONTENT)) {
+											VariableContent::Koord k = varTable.getContent(cell->getIdentNumber()).getKoord(block.getBlockIdent());
 											k.x += mainX - block.getX();
 											k.y += mainY - block.getY();
 											if ((k.x != x1 || k.y != y1)
@@ -381,11 +509,11 @@ private:
 		}
 	}
 
-	int computeTerm(counted_ptr<Term> t, Block & block) {
+	int computeTerm(arena_ptr<Term> t, Block & block) {
 		switch(t->getType()) {
 		case T_NUMBER:		return static_cast<TermIdentNumber*>(t.get())->getIdentName();
 		case T_IDENTIFIER:	{
-								VariableContent::Koord k = static_cast<VariableContent*>(varTable[static_cast<TermIdentNumber*>(t.get())->getIdentName()].get())->getKoord(block.getBlockIdent());
+								VariableContent::Koord k = varTable.getContent(static_cast<TermIdentNumber*>(t.get())->getIdentName()).getKoord(block.getBlockIdent());
 								k.x += mainX - block.getX();
 								k.y += mainY - block.getY();
 								if (get(k.x, k.y).getType() != CELL_NUMBER) {
@@ -427,20 +555,20 @@ private:
 		} else {
 
 			Block & b = file.blocks[vec[0]];
-			counted_ptr<Picture<counted_ptr<CellStatement>>> pic = b.getRight();
+			arena_ptr<Picture<arena_ptr<CellStatement>>> pic = b.getRight();
 			for (int x = 0; x < cellX; x++)
 				for (int y = 0; y < cellY; y++) {
 					if (file.head.getCell()->get(x,y)->getType() != EMPTY) {
 						CellStatement c1 = *(pic->get(x,y));
-						if ((c1.getType() == CELL_IDENTIFIER) && (varTable[c1.getIdentNumber()]->getType() == VAR_CONTENT)) {
-							VariableContent::Koord k = static_cast<VariableContent*>(varTable[c1.getIdentNumber()].get())->getKoord(b.getBlockIdent());
+						if ((c1.getType() == CELL_IDENTIFIER) && (varTable.is(c1.getIdentNumber(), VAR_CONTENT))) {
+							VariableContent::Koord k = varTable.getContent(c1.getIdentNumber()).getKoord(b.getBlockIdent());
 							k.x += mainX - b.getX();
 							k.y += mainY - b.getY();
 							c1 = get(k.x, k.y);
 						} else if (c1.getType() == EMPTY) {
 							c1 = get(mainX+x, mainY+y);
 						} else if (c1.getType() == CELL_TERM) {
-							c1 = CellStatement(CELL_NUMBER, computeTerm(c1.getTerm(), b), counted_ptr<Set>(NULL));
+							c1 = CellStatement(CELL_NUMBER, computeTerm(c1.getTerm(), b), arena_ptr<Set>(NULL));
 						}
 
 						for (int i = 0; i < setLists.get(x,y)->size(); i++) {
@@ -463,15 +591,15 @@ private:
 	}
 
 	void testResultLegal(Block & b) {
-		counted_ptr<Picture<counted_ptr<CellStatement>>> pic = b.getRight();
+		arena_ptr<Picture<arena_ptr<CellStatement>>> pic = b.getRight();
 		for (int x = 0; x < cellX; x++)
 			for (int y = 0; y < cellY; y++) {
 				if ((pic->get(x,y)->getType() == CELL_IDENTIFIER ||
 					pic->get(x,y)->getType() == IDENTIFIER_IN_SET) &&
-					varTable[pic->get(x,y)->getIdentNumber()]->getType() == VAR_CONTENT) {
+					varTable.is(pic->get(x,y)->getIdentNumber(), VAR_CONTENT)) {
 						// tests if all variables used in the result are legal in there cells
 						
-						VariableContent::Koord k = static_cast<VariableContent*>(varTable[pic->get(x,y)->getIdentNumber()].get())->getKoord(b.getBlockIdent());
+						VariableContent::Koord k = varTable.getContent(pic->get(x,y)->getIdentNumber()).getKoord(b.getBlockIdent());
 							
 						k.x += mainX - b.getX();
 						k.y += mainY - b.getY();
@@ -488,7 +616,7 @@ private:
 				} else if (pic->get(x,y)->getType() == CELL_TERM || pic->get(x,y)->getType() == TERM_IN_SET) {
 						//tests if all terms compute to something thats legal in their cells
 								
-						CellStatement temp(CELL_NUMBER, computeTerm(pic->get(x,y)->getTerm(), b), counted_ptr<Set>(NULL));
+						CellStatement temp(CELL_NUMBER, computeTerm(pic->get(x,y)->getTerm(), b), arena_ptr<Set>(NULL));
 						if (!inSet(temp, posSet.get(x,y), b)) {
 							outStream << "    Error: this mapping is illegal it contains a term that computes to an illegal number for its cell";
 							error << printInstance() << "    Error: this mapping is illegal it contains a term that computes to an illegal number for its cell" << endl;
@@ -504,28 +632,28 @@ private:
 		for (int x = 0; x < cellX; x++)
 			for (int y = 0; y < cellY; y++) {
 				c0 = *file.blocks[v[0]].getRight()->get(x,y);
-				if (c0.getType() == CELL_IDENTIFIER && varTable[c0.getIdentNumber()]->getType() == VAR_CONTENT) {
-					VariableContent::Koord k = static_cast<VariableContent*>(varTable[c0.getIdentNumber()].get())->getKoord(file.blocks[v[0]].getBlockIdent());
+				if (c0.getType() == CELL_IDENTIFIER && varTable.is(c0.getIdentNumber(), VAR_CONTENT)) {
+					VariableContent::Koord k = varTable.getContent(c0.getIdentNumber()).getKoord(file.blocks[v[0]].getBlockIdent());
 					k.x += mainX - file.blocks[v[0]].getX();
 					k.y += mainY - file.blocks[v[0]].getY();
 					c0 = get(k.x,k.y);
 				} else if (c0.getType() == EMPTY && file.head.getCell()->get(x,y)->getType() != EMPTY) {
 					c0 = get(mainX + x, mainY + y);
 				} else if (c0.getType() == CELL_TERM) {
-					c0 = CellStatement(CELL_NUMBER, computeTerm(c0.getTerm(), file.blocks[v[0]]), counted_ptr<Set>(NULL));
+					c0 = CellStatement(CELL_NUMBER, computeTerm(c0.getTerm(), file.blocks[v[0]]), arena_ptr<Set>(NULL));
 				}
 				for (int i = 1; i < v.size(); i++) {
 					c1 = *file.blocks[v[i]].getRight()->get(x,y);
 					if (c1.getType() == CELL_IDENTIFIER &&
-						varTable[c1.getIdentNumber()]->getType() == VAR_CONTENT) {
-						VariableContent::Koord k = static_cast<VariableContent*>(varTable[c1.getIdentNumber()].get())->getKoord(file.blocks[v[i]].getBlockIdent());
+						varTable.is(c1.getIdentNumber(), VAR_CONTENT)) {
+						VariableContent::Koord k = varTable.getContent(c1.getIdentNumber()).getKoord(file.blocks[v[i]].getBlockIdent());
 						k.x += mainX - file.blocks[v[i]].getX();
 						k.y += mainY - file.blocks[v[i]].getY();
 						c1 = get(k.x,k.y);
 					} else if (c1.getType() == EMPTY && file.head.getCell()->get(x,y)->getType() != EMPTY) {
 						c1 = get(mainX + x, mainY + y);
 					} else if (c1.getType() == CELL_TERM) {
-						c1 = CellStatement(CELL_NUMBER, computeTerm(c1.getTerm(), file.blocks[v[i]]), counted_ptr<Set>(NULL));
+						c1 = CellStatement(CELL_NUMBER, computeTerm(c1.getTerm(), file.blocks[v[i]]), arena_ptr<Set>(NULL));
 					}
 					if (c0.getType() != c1.getType() ||
 						c0.getIdentNumber() != c1.getIdentNumber()) return false;
@@ -534,11 +662,18 @@ private:
 		return true;
 	}
 
-	bool inSet(CellStatement & cell, counted_ptr<Set> set, Block & block) {
+	bool inSet(CellStatement & cell, arena_ptr<Set> set, Block & block) {
+		// the members of a shared set without local variables are the same for every instance
+		int id = set->getNodeId();
+		if (id >= 0 && !isLocal(set)) {
+			valuesOf(set);
+			const ValueSet & values = setValues[id];
+			if (cell.getType() == CELL_NUMBER) return values.containsNumber(cell.getIdentNumber());
+			return values.containsIdentifier(cell.getIdentNumber());
+		}
 		switch(set->getType()) {
 			case SET_IDENTIFIER:{	
-				VariableSet* vset = static_cast<VariableSet*>(varTable[static_cast<SetIdentifier*>(set.get())->getName()].get());
-				return inSet(cell, vset->getSet(), block);
+				return inSet(cell, varTable.getSet(static_cast<SetIdentifier*>(set.get())->getName()), block);
 			}
 			case SET_ENUM:		{	
 				SetList * lset = static_cast<SetList*>(set.get());
@@ -548,8 +683,8 @@ private:
 				}
 				vec = lset->getIdentifiers();
 				for (int i = 0; i < vec.size(); i++) {
-					if (varTable[vec[i]]->getType() == VAR_CONTENT) {
-						VariableContent::Koord k = static_cast<VariableContent*>(varTable[vec[i]].get())->getKoord(block.getBlockIdent());
+					if (varTable.is(vec[i], VAR_CONTENT)) {
+						VariableContent::Koord k = varTable.getContent(vec[i]).getKoord(block.getBlockIdent());
 						k.x += mainX - block.getX();
 						k.y += mainY - block.getY();
 						if (cell.getType() == get(k.x,k.y).getType()
@@ -598,7 +733,7 @@ private:
 
 	
 	void prepareTableVariables() {
-		varUsed.setSize(3,3);
+		varUsed.clear();
 		// First look which cells need to bee expressed through a variable
 		for (int x = 0; x < instance.getWidth(); x++) {
 			int i = (x < cellX) ? 0 : ((x < mainX+cellX) ? 1 : 2);
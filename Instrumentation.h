@@ -0,0 +1,135 @@
+#ifndef _INSTRUMENTATION_H_
+#define _INSTRUMENTATION_H_
+
+#include <cstdlib>
+#include <ctime>
+#include <new>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <utility>
+#include <ostream>
+#include <iomanip>
+#include <sys/resource.h>
+
+using namespace std;
+
+// operator new calls made by the current thread, counted by the replacement
+// operators in AllocationCounter.cpp; stays 0 in a binary that does not link it
+inline unsigned long long & allocationCount() {
+	static thread_local unsigned long long count = 0;
+	return count;
+}
+
+struct PhaseRecord {
+	string name;
+	double start, wall, cpu;        // ms, start since the first phase
+	long peakRss;                   // kB, of the whole process at the end of the phase
+	unsigned long long allocations;
+};
+
+/**
+ * Wall time, CPU time of the calling thread, peak RSS and allocations of
+ * the phases of one compilation, plus named counters the phases report.
+ * The phases have to be run on the thread that measures them; work they
+ * hand to other threads is not in their CPU time and allocations. The
+ * peak RSS is the one of the whole process so far, with several files
+ * compiled at once it says nothing about a single one.
+ */
+class Instrumentation {
+public:
+	Instrumentation() : origin(chrono::steady_clock::now()) { }
+
+	void begin(const string & name) {
+		current.name = name;
+		current.start = sinceOrigin();
+		startCpu = threadCpu();
+		startAllocations = allocationCount();
+	}
+
+	void end() {
+		current.wall = sinceOrigin() - current.start;
+		current.cpu = threadCpu() - startCpu;
+		current.allocations = allocationCount() - startAllocations;
+		struct rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		current.peakRss = usage.ru_maxrss;
+		phases.push_back(current);
+	}
+
+	void count(const string & name, unsigned long long n) {
+		counters.push_back(make_pair(name, n));
+	}
+
+	const vector<PhaseRecord> & getPhases() const {
+		return phases;
+	}
+
+	const vector<pair<string, unsigned long long> > & getCounters() const {
+		return counters;
+	}
+
+	void writeTable(ostream & out) const {
+		out << "phase                 wall ms    cpu ms  allocations  process peak RSS kB" << endl;
+		for (int i = 0; i < phases.size(); i++) {
+			out << left << setw(20) << phases[i].name << right << fixed << setprecision(3)
+				<< setw(10) << phases[i].wall << setw(10) << phases[i].cpu
+				<< setw(13) << phases[i].allocations << setw(21) << phases[i].peakRss << endl;
+		}
+		out << endl;
+		for (int i = 0; i < counters.size(); i++)
+			out << left << setw(21) << (counters[i].first + ":") << counters[i].second << endl;
+		out << right;
+	}
+
+	/**
+	 * The phases as complete events ("ph":"X") of the Chrome trace event
+	 * format, without the enclosing array. tid tells files apart in a batch.
+	 */
+	void writeTraceEvents(ostream & out, const string & file, int tid, double offset, bool & first) const {
+		for (int i = 0; i < phases.size(); i++) {
+			if (!first) out << "," << endl;
+			first = false;
+			out << fixed << setprecision(3)
+				<< "{\"name\":\"" << phases[i].name << "\",\"cat\":\"compile\",\"ph\":\"X\""
+				<< ",\"ts\":" << (offset + phases[i].start) * 1000 << ",\"dur\":" << phases[i].wall * 1000
+				<< ",\"pid\":1,\"tid\":" << tid
+				<< ",\"args\":{\"file\":\"" << escape(file) << "\",\"cpu_ms\":" << phases[i].cpu
+				<< ",\"process_peak_rss_kb\":" << phases[i].peakRss << ",\"allocations\":" << phases[i].allocations << "}}";
+		}
+	}
+
+	// ms since the epoch of the steady clock, so events of several compilations line up
+	double getOrigin() const {
+		return chrono::duration<double, milli>(origin.time_since_epoch()).count();
+	}
+
+private:
+	chrono::steady_clock::time_point origin;
+	PhaseRecord current;
+	double startCpu;
+	unsigned long long startAllocations;
+	vector<PhaseRecord> phases;
+	vector<pair<string, unsigned long long> > counters;
+
+	double sinceOrigin() const {
+		return chrono::duration<double, milli>(chrono::steady_clock::now() - origin).count();
+	}
+
+	static double threadCpu() {
+		timespec t;
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+		return t.tv_sec * 1000.0 + t.tv_nsec / 1000000.0;
+	}
+
+	static string escape(const string & s) {
+		string result;
+		for (int i = 0; i < s.size(); i++) {
+			if (s[i] == '"' || s[i] == '\\') result.push_back('\\');
+			result.push_back(s[i]);
+		}
+		return result;
+	}
+};
+
+#endif
@@ -4,41 +4,182 @@
 #include <iostream>
 #include <fstream>
 #include <cstdlib>
+#include <cstring>
+#include <climits>
 #include <string>
 #include <vector>
+#include <algorithm>
 #include "Token.h"
 #include "StringTable.h"
 #include "TilingAutomaton.h"
-#include <queue>
+#include "CharScanner.h"
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 using namespace std;
 
+/**
+ * A line of text that is read but never copied. Characters marked in
+ * the consumed mask (parts of pictures already turned into tokens)
+ * read as spaces.
+ */
+struct TextLine {
+    TextLine(const char * chars, int length, const unsigned char * mask = NULL)
+        : chars(chars), length(length), mask(mask) { }
+
+    TextLine(const string & str) : chars(str.data()), length(str.size()), mask(NULL) { }
+
+    int size() const {
+        return length;
+    }
+
+    char operator[](int x) const {
+        return (mask && mask[x]) ? ' ' : chars[x];
+    }
+
+    // first position from x on not holding c
+    int skip(int x, char c) const {
+        return CharScanner::skip(chars, mask, x, length, c);
+    }
+
+    // first position from x on that is not a space, letter, digit, '-', '_' or '.'
+    int findStructural(int x) const {
+        return CharScanner::findStructural(chars, mask, x, length);
+    }
+
+    const char * chars;
+    int length;
+    const unsigned char * mask;
+};
+
 class Lexer {
 public:
-    Lexer(string fileName, StringTable & pStrTbl) : strTbl(pStrTbl), posy(-1) {
-        readToVector(fileName);
+    Lexer(string fileName, StringTable & pStrTbl)
+        : strTbl(pStrTbl), posy(-1), readPos(0), data(NULL), dataSize(0), mapped(false), input(NULL), source(this), nextPicture(0) {
+        readFile(fileName);
+        indexPictures();
+        lastLine = lineCount() - 1;
+    }
+
+    // a file already in memory, the text is not copied and has to outlive the lexer
+    Lexer(const char * text, size_t size, StringTable & pStrTbl)
+        : strTbl(pStrTbl), posy(-1), readPos(0), data(text), dataSize(size), mapped(false), input(NULL), source(this), nextPicture(0) {
+        indexLines();
+        indexPictures();
+        lastLine = lineCount() - 1;
+    }
+
+    /**
+     * Streaming mode: reads the text line by line and only keeps a window
+     * from the line being lexed down to the bottom of the tallest picture
+     * starting there. Pictures are found and tokens dropped as the parser
+     * goes, so the memory of the lexer does not grow with the file.
+     */
+    Lexer(istream & in, StringTable & pStrTbl)
+        : strTbl(pStrTbl), posy(-1), lastLine(INT_MAX), readPos(0), data(NULL), dataSize(0), mapped(false), input(&in),
+          windowFirst(0), windowEnd(0), ring(64), ringMask(64), source(this), nextPicture(0) { }
+
+    /**
+     * Lexes only the lines [firstLine, lastLine] of an already read file,
+     * with tokens and identifiers of its own. Used to lex blocks on
+     * several threads, the whole file has to outlive it.
+     */
+    Lexer(Lexer & whole, int firstLine, int lastLine, StringTable & pStrTbl)
+        : strTbl(pStrTbl), posy(firstLine - 1), lastLine(lastLine), readPos(0), data(NULL), dataSize(0), mapped(false), input(NULL), source(&whole) {
+        PictureEntry first;
+        first.y = firstLine;
+        nextPicture = lower_bound(whole.pictures.begin(), whole.pictures.end(), first, pictureBefore) - whole.pictures.begin();
     }
 
-    counted_ptr<Token> next() {
-        while (buffer.empty()) {
-            if (++posy < text.size()) parseString(text[posy]);
-            else return counted_ptr<Token>(new Token(EOFILE));
+    ~Lexer() {
+#ifndef WIN32
+        if (mapped) munmap(const_cast<char *>(data), dataSize);
+#endif
+    }
+
+    // index of the next token, lexes further lines as needed
+    int next() {
+        while (readPos == tokens.size()) {
+            if (input) {
+                // the parser copies every token it reads
+                tokens.clear();
+                readPos = 0;
+            }
+            if ((++posy <= lastLine) && hasLine(posy)) {
+                if (input) advanceWindow(posy);
+                parseString(line(posy));
+            } else {
+                if (tokens.empty() || tokens.back().getType() != EOFILE) push_token(EOFILE);
+                return tokens.size() - 1;
+            }
+        }
+        return readPos++;
+    }
+
+    const Token & getToken(int index) {
+        return tokens[index];
+    }
+
+    // lexes up to the end, so that lexing and parsing can be done in separate passes
+    void lexAll() {
+        while (getToken(next()).getType() != EOFILE);
+        readPos = 0;
+    }
+
+    // moves the identifiers of the tokens from this lexer's string table to the given one
+    void internInto(StringTable & global) {
+        for (int i = 0; i < tokens.size(); i++)
+            if (tokens[i].getType() == IDENTIFIER)
+                tokens[i] = Token::identifier(global.getIdentity(strTbl.getString(tokens[i].getIdentity()), strTbl.getLength(tokens[i].getIdentity())));
+    }
+
+    // only known up front when not streaming
+    int lineCount() {
+        return source->lineStart.size();
+    }
+
+    bool isStreaming() {
+        return source->input != NULL;
+    }
+
+    // lines holding nothing but '___' once the pictures are blanked, where the file can be split into blocks
+    vector<int> separatorLines() {
+        vector<int> result;
+        for (int y = 0; y < lineCount(); y++) {
+            bool underscore(false), other(false);
+            for (int x = 0; (x < lineSize(y)) && !other; x++) {
+                char c = at(y, x);
+                if (c == '_') underscore = true;
+                else if ((c != ' ') && (c != '\r')) other = true;
+            }
+            if (underscore && !other) result.push_back(y);
         }
-        counted_ptr<Token>  result = buffer.front();
-        buffer.pop();
         return result;
     }
 
     void push_token(TokenType ttype) {
-        buffer.push(counted_ptr<Token>(new Token(ttype)));
+        tokens.push_back(Token(ttype));
     }
 
-    void parseString(string line, bool inPic = false) {
+    void parseString(const TextLine & line, bool inPic = false) {
         int x = 0;
         while (x < line.size()) {
+            const vector<PictureEntry> & pictures = source->pictures;
+            if (!inPic && (nextPicture < pictures.size()) && (pictures[nextPicture].y == posy) && (pictures[nextPicture].x == x)) {
+                emitPicture(pictures[nextPicture++]);
+            }
             switch(line[x]) {
                 case '\r': x++; break;
-                case ' ': x++; break;
+                case ' ':
+                    // corners of indexed pictures read as spaces too
+                    x = line.skip(x, ' ');
+                    if (!inPic && (nextPicture < pictures.size()) && (pictures[nextPicture].y == posy))
+                        x = min(x, pictures[nextPicture].x);
+                    break;
                 case '-': x++; push_token(MINUS); break;
                 case '*': x++; push_token(STAR);break;
                 case '%': x++; push_token(PERCENT);break;
@@ -51,6 +192,9 @@ public:
                 case '$': x++; push_token(MAIN_CELL);break;
                 case '.':
                     while ((x < line.size()) && ((line[x] == '.') || (line[x] == ' '))) x++;
+                    // the spaces may run over the corner of an indexed picture, as above
+                    if (!inPic && (nextPicture < pictures.size()) && (pictures[nextPicture].y == posy))
+                        x = min(x, pictures[nextPicture].x);
                     push_token(DOT_DOT_DOT);
                     break;
                 case '/':
@@ -91,15 +235,9 @@ public:
                             push_token(NOT_EQ);
                     } else push_token(ERROR);
                     break;
-                case '+':
-                    if ((++x < line.size()) && (line[x] == '-') && !inPic) {
-                        parsePicture(x -1, posy);
-                        parseString(text[posy]);
-                        return;
-                    } else push_token(PLUS);
-                    break;
+                case '+': x++; push_token(PLUS); break;
                 case '_':
-                    while ((x < line.size()) && (line[x] == '_')) x++;
+                    x = line.skip(x, '_');
                     push_token(LINE);
                     break;
                 default:
@@ -118,24 +256,220 @@ public:
     }
 
 private:
-    vector<string> text;
-    int posy;
+    int posy, lastLine;
     StringTable & strTbl;
-    queue<counted_ptr<Token>> buffer;
-    TilingAutomaton tAuto;
+    vector<Token> tokens;
+    int readPos;
+
+    // the whole file, mapped read-only if possible
+    const char * data;
+    size_t dataSize;
+    bool mapped;
+    string fallback;
+
+    vector<size_t> lineStart;
+    vector<int> lineLength;
+    // one byte per byte of data, 0xff for text already turned into tokens
+    vector<unsigned char> consumed;
+
+    // streaming mode: lines [windowFirst, windowEnd) are kept in a ring
+    // whose size is a power of two, line y in slot y & (ring.size() - 1)
+    istream * input;
+    int windowFirst, windowEnd;
+    vector<string> ring;
+    vector<vector<unsigned char> > ringMask;
+
+    /**
+     * A picture found by the sweep: its corner, the columns and rows of
+     * its grid lines in text coordinates and whether the tiling automaton
+     * accepted it.
+     */
+    struct PictureEntry {
+        int x, y;
+        vector<int> xvec, yvec;
+        bool valid;
+    };
+
+    // all pictures of the file in reading order of their corners
+    vector<PictureEntry> pictures;
+    // the lexer owning the text, this one unless lexing a range of another
+    Lexer * source;
+    size_t nextPicture;
+
+    static bool pictureBefore(const PictureEntry & a, const PictureEntry & b) {
+        return a.y < b.y;
+    }
+
+    // the automaton does not depend on the file, it is built once and only read
+    static TilingAutomaton & automaton() {
+        static TilingAutomaton tAuto;
+        return tAuto;
+    }
+
+    Lexer(const Lexer &);
+    Lexer & operator=(const Lexer &);
+
+    /**
+     * Picture region of the text handed to the tiling automaton without
+     * copying it, positions beyond the end of a line read as spaces.
+     */
+    class TextPicture {
+    public:
+        TextPicture(Lexer & lexer, int x0, int y0, int width, int height, bool raw = false)
+            : lexer(lexer), x0(x0), y0(y0), width(width), height(height), raw(raw) { }
+
+        int getWidth() const {
+            return width;
+        }
+
+        int getHeight() const {
+            return height;
+        }
+
+        char get(int i, int j) const {
+            if ((0 <= i) && (i < width) && (0 <= j) && (j < height)) {
+                return raw ? lexer.rawAt(y0 + j, x0 + i) : lexer.at(y0 + j, x0 + i);
+            }
+            return '#';
+        }
+
+    private:
+        Lexer & lexer;
+        int x0, y0, width, height;
+        // ignores the consumed bitmap, for pictures already indexed
+        bool raw;
+    };
+
+    void readFile(const string & fileName) {
+#ifndef WIN32
+        int fd = open(fileName.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void * p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                data = static_cast<const char *>(p);
+                dataSize = st.st_size;
+                mapped = true;
+            }
+        }
+        close(fd);
+#endif
+        if (!mapped) {
+            ifstream fileStream(fileName, ios::in | ios::binary);
+            if (!fileStream) return;
+            fallback.assign(istreambuf_iterator<char>(fileStream), istreambuf_iterator<char>());
+            data = fallback.data();
+            dataSize = fallback.size();
+        }
+        indexLines();
+    }
+
+    void indexLines() {
+        size_t start = 0;
+        for (size_t i = 0; i < dataSize; i++) {
+            if (data[i] == '\n') {
+                lineStart.push_back(start);
+                lineLength.push_back(i - start);
+                start = i + 1;
+            }
+        }
+        if (start < dataSize) {
+            lineStart.push_back(start);
+            lineLength.push_back(dataSize - start);
+        }
+        consumed.assign(dataSize, 0);
+    }
+
+    // true if there is a line y, when streaming it is read into the window
+    bool hasLine(int y) {
+        Lexer & s = *source;
+        if (!s.input) return y < s.lineStart.size();
+        while (y >= s.windowEnd) {
+            if (!s.readLine()) return false;
+        }
+        return true;
+    }
+
+    int lineSize(int y) {
+        const Lexer & s = *source;
+        if (s.input) return s.ring[s.slot(y)].size();
+        return s.lineLength[y];
+    }
 
-    void readToVector(const string & fileName) {
+    // stays valid until the window grows
+    TextLine line(int y) {
+        const Lexer & s = *source;
+        if (s.input) {
+            int k = s.slot(y);
+            return TextLine(s.ring[k].data(), s.ring[k].size(), s.ringMask[k].data());
+        }
+        return TextLine(s.data + s.lineStart[y], s.lineLength[y], s.consumed.data() + s.lineStart[y]);
+    }
 
-        ifstream fileStream(fileName, ios::in);
-        if (!fileStream) return;
+    char at(int y, int x) {
+        const Lexer & s = *source;
+        if (s.input) {
+            int k = s.slot(y);
+            if (x >= s.ring[k].size() || s.ringMask[k][x]) return ' ';
+            return s.ring[k][x];
+        }
+        if (x >= s.lineLength[y] || s.consumed[s.lineStart[y] + x]) return ' ';
+        return s.data[s.lineStart[y] + x];
+    }
 
-        string line;
+    char rawAt(int y, int x) {
+        const Lexer & s = *source;
+        if (s.input) {
+            int k = s.slot(y);
+            return (x >= s.ring[k].size()) ? ' ' : s.ring[k][x];
+        }
+        if (x >= s.lineLength[y]) return ' ';
+        return s.data[s.lineStart[y] + x];
+    }
 
-        while(getline(fileStream,line)) {
-            text.push_back(line);
+    // marks [x0, x1] of line y as turned into tokens
+    void consume(int y, int x0, int x1) {
+        if (input) {
+            vector<unsigned char> & mask = ringMask[slot(y)];
+            for (int x = x0; x <= x1 && x < mask.size(); x++) mask[x] = 0xff;
+            return;
         }
+        for (int x = x0; x <= x1 && x < lineLength[y]; x++) consumed[lineStart[y] + x] = 0xff;
+    }
 
-        fileStream.close();
+    int slot(int y) const {
+        return y & (ring.size() - 1);
+    }
+
+    // appends the next line of the input to the window, doubling the ring when it is full
+    bool readLine() {
+        if (windowEnd - windowFirst == ring.size()) {
+            vector<string> grownRing(2 * ring.size());
+            vector<vector<unsigned char> > grownMask(2 * ring.size());
+            for (int y = windowFirst; y < windowEnd; y++) {
+                int k = y & (grownRing.size() - 1);
+                grownRing[k].swap(ring[slot(y)]);
+                grownMask[k].swap(ringMask[slot(y)]);
+            }
+            ring.swap(grownRing);
+            ringMask.swap(grownMask);
+        }
+        int k = slot(windowEnd);
+        if (!getline(*input, ring[k])) return false;
+        ringMask[k].assign(ring[k].size(), 0);
+        windowEnd++;
+        return true;
+    }
+
+    // drops the lines above y and finds the pictures starting on it
+    void advanceWindow(int y) {
+        windowFirst = y;
+        if (nextPicture == pictures.size()) {
+            pictures.clear();
+            nextPicture = 0;
+        }
+        sweepLine(y);
     }
 
     inline bool isDigit(char c) {
@@ -155,65 +489,100 @@ private:
     //	//posy += pic.GetHeight() - 1;
     //}
 
-    int parseNumber(const string & line, int x) {
+    int parseNumber(const TextLine & line, int x) {
         int posx = x;
         int result = digitToInt(line[posx]);
         while ((++posx < line.size()) && isDigit(line[posx])) {
             result *= 10;
             result += digitToInt(line[posx]);
         }
-        buffer.push(counted_ptr<Token>(new NumberToken(result)));
+        tokens.push_back(Token::number(result));
         return posx;
     }
 
-    int parseIdentifier(const string & line, int x) {
+    int parseIdentifier(const TextLine & line, int x) {
         int posx = x;
-        string result = "";
-        result.push_back(line[posx]);
-        while ((++posx < line.size()) && (isChar(line[posx]) || isDigit(line[posx]))) result.push_back(line[posx]);
+        while ((++posx < line.size()) && (isChar(line[posx]) || isDigit(line[posx])));
+        // the characters read are not masked, they stand in the line as they are
+        const char * start = line.chars + x;
+        int length = posx - x;
 
-        if (result == "in") {
+        if (isWord(start, length, "in")) {
             push_token(IN);
             return posx;
-        } else if (result == "turn") {
+        } else if (isWord(start, length, "turn")) {
             push_token(TURN);
             return posx;
-        } else if (result == "else") {
+        } else if (isWord(start, length, "else")) {
             push_token(ELSE);
             return posx;
-        } else if (result == "mirrorX") {
+        } else if (isWord(start, length, "mirrorX")) {
             push_token(MIRROR_X);
             return posx;
-        } else if (result == "mirrorY") {
+        } else if (isWord(start, length, "mirrorY")) {
             push_token(MIRROR_Y);
             return posx;
-        } else if (result == "nopointer") {
+        } else if (isWord(start, length, "nopointer")) {
             push_token(NO_POINTER);
             return posx;
         }
 
-        int ident = strTbl.getIdentity(result);
-        buffer.push(counted_ptr<Token>(new IdentifierToken(ident)));
+        int ident = strTbl.getIdentity(start, length);
+        tokens.push_back(Token::identifier(ident));
         return posx;
     }
 
+    static bool isWord(const char * start, int length, const char * word) {
+        return strncmp(start, word, length) == 0 && word[length] == '\0';
+    }
+
+    // one pass over the text finding every picture before any token is made
+    void indexPictures() {
+        for (int y = 0; y < lineCount(); y++) sweepLine(y);
+    }
+
+    // visits line y as far as parseString would: up to a comment or a character no token starts with
+    void sweepLine(int y) {
+        TextLine text = line(y);
+        for (int x = text.findStructural(0); x < text.size(); x = text.findStructural(x + 1)) {
+            char c = text[x];
+            if ((c == '/') && (at(y, x+1) == '/')) return;
+            if ((c == '+') && (at(y, x+1) == '-')) {
+                pictures.push_back(findPicture(x, y));
+                const PictureEntry & pic = pictures.back();
+                for (int j = pic.yvec.front(); j <= pic.yvec.back(); j++) consume(j, pic.xvec.front(), pic.xvec.back());
+                // finding the picture may have grown the window
+                text = line(y);
+            } else if (!startsToken(c)) return;
+        }
+    }
+
+    inline bool startsToken(char c) {
+        return isDigit(c) || isChar(c) || (c != '\0' && string(" \r-*%(){},?$./=<>!+_").find(c) != string::npos);
+    }
+
     // has to be called with the highest leftest +
-    void parsePicture(int x, int y) {
-        vector<int> xvec, yvec;
+    PictureEntry findPicture(int x, int y) {
+        PictureEntry entry;
+        entry.x = x;
+        entry.y = y;
+        vector<int> & xvec = entry.xvec;
+        vector<int> & yvec = entry.yvec;
 
         int i= 0;
         //get initial width
-        while((x+i) < text.at(y).size()) {
-            if (text.at(y)[x+i] == '+') xvec.push_back(x+i);
-            else if (text.at(y)[x+i] != '-') break;
-            i++;
+        TextLine top = line(y);
+        for (int k = x; k < top.size(); ) {
+            if (top[k] == '+') xvec.push_back(k++);
+            else if (top[k] == '-') k = top.skip(k, '-');
+            else break;
         }
 
         i=0;
         //get initial height
-        while(((y+i) < text.size()) && (x < text[y+i].size())) {
-            if (text.at(y+i)[x] == '+') yvec.push_back(y+i);
-            else if (text.at(y+i)[x] != '|') break;
+        while(hasLine(y+i) && (x < lineSize(y+i))) {
+            if (at(y+i, x) == '+') yvec.push_back(y+i);
+            else if (at(y+i, x) != '|') break;
             i++;
         }
 
@@ -223,32 +592,32 @@ private:
         for (int k = 0; k < yvec.size(); k++) {
             i = 1;
             while ((xvec.front()-i) >= 0) {
-                if (text.at(yvec[k])[xvec.front()-i] == '+') {
+                if (at(yvec[k], xvec.front()-i) == '+') {
                     xvec.insert(xvec.begin(), xvec.front()-i);
                     i=1;
-                } else if (text.at(yvec[k])[xvec.front()-i] != '-') break;
+                } else if (at(yvec[k], xvec.front()-i) != '-') break;
                 i++;
             }
         }
-        //expand right
+        //expand right, the character right of a found + is not looked at
         for (int k = 0; k < yvec.size(); k++) {
-            i = 1;
-            while ((xvec.back()+i) < text.at(yvec[k]).size()) {
-                if (text.at(yvec[k])[xvec.back()+i] == '+') {
-                    xvec.push_back(xvec.back()+i);
-                    i=1;
-                } else if (text.at(yvec[k])[xvec.back()+i] != '-') break;
-                i++;
+            TextLine row = line(yvec[k]);
+            for (int l = xvec.back() + 1; l < row.size(); ) {
+                if (row[l] == '+') {
+                    xvec.push_back(l);
+                    l += 2;
+                } else if (row[l] == '-') l = row.skip(l, '-');
+                else break;
             }
         }
         //expand bottom
         for (int k = 0; k < xvec.size(); k++) {
             i = 1;
-            while (((yvec.back() + i) < text.size()) && (xvec[k] < text.at(yvec.back()+i).size())) {
-                if (text.at(yvec.back()+i)[xvec[k]] == '+') {
+            while (hasLine(yvec.back()+i) && (xvec[k] < lineSize(yvec.back()+i))) {
+                if (at(yvec.back()+i, xvec[k]) == '+') {
                     yvec.push_back(yvec.back()+i);
                     i=1;
-                } else if (text.at(yvec.back()+i)[xvec[k]] != '|') break;
+                } else if (at(yvec.back()+i, xvec[k]) != '|') break;
                 i++;
             }
         }
@@ -258,65 +627,51 @@ private:
             if (yvec[i-1] == yvec[i] -1) yvec.erase(yvec.begin()+i, yvec.end());
         }
 
-        //copy Picture from vector to pic
-        Picture<char> pic = Picture<char>('#');
-        pic.setSize(xvec.back() - xvec.front() + 1, yvec.back() - yvec.front() + 1);
-        for(int l = yvec.front(); l <= yvec.back(); l++) {
-            for(int k = xvec.front(); k <= xvec.back(); k++) {
-                if (k < text.at(l).size()) pic.set(k - xvec.front(),l - yvec.front(),text.at(l).at(k));
-                else pic.set(k - xvec.front(),l - yvec.front(),' ');
-            }
-        }
+        TextPicture pic(*this, xvec.front(), yvec.front(), xvec.back() - xvec.front() + 1, yvec.back() - yvec.front() + 1);
 
 
-        if (tAuto.testPicture(&pic)) {
-            //parse Picture
-            buffer.push(counted_ptr<Token>(new PictureToken(xvec.size() -1, yvec.size() -1)));
-            int xt(xvec.front()), yt(yvec.front());
-            for (int i = 0; i < xvec.size(); i++) xvec[i] -= xt;
-            for (int i = 0; i < yvec.size(); i++) yvec[i] -= yt;
-            for (int i = 0; i < (xvec.size() -1); i++) {
-                for (int j = 0; j < (yvec.size() -1); j++) {
-                    //parse cell (i,j  ) (i+1,j  )
-                    //           (i,j+1) (i+1,j+1)
-
-
-                    // if cell is interior
-                    if (pic.get(xvec[i]  , yvec[j]  ) == '+' &&
-                        pic.get(xvec[i+1], yvec[j]  ) == '+' &&
-                        pic.get(xvec[i]  , yvec[j+1]) == '+' &&
-                        pic.get(xvec[i+1], yvec[j+1]) == '+') {
-
-                        buffer.push(counted_ptr<Token>(new CellToken(i,j)));
-
-                        string cell = "";
-                        for (int k = yvec[j]+1; k < yvec[j+1]; k++) {
-                            for (int l = xvec[i]+1; l < xvec[i+1]; l++) {
-                                cell.push_back(pic.get(l,k));
-                            }
-                            cell.push_back(' ');
+        entry.valid = automaton().testPicture(&pic);
+        return entry;
+    }
+
+    void emitPicture(const PictureEntry & entry) {
+        if (!entry.valid) {
+            push_token(ERROR);
+            return;
+        }
+        vector<int> xvec(entry.xvec), yvec(entry.yvec);
+        TextPicture pic(*this, xvec.front(), yvec.front(), xvec.back() - xvec.front() + 1, yvec.back() - yvec.front() + 1, true);
+
+        tokens.push_back(Token::picture(xvec.size() -1, yvec.size() -1));
+        int xt(xvec.front()), yt(yvec.front());
+        for (int i = 0; i < xvec.size(); i++) xvec[i] -= xt;
+        for (int i = 0; i < yvec.size(); i++) yvec[i] -= yt;
+        for (int i = 0; i < (xvec.size() -1); i++) {
+            for (int j = 0; j < (yvec.size() -1); j++) {
+                //parse cell (i,j  ) (i+1,j  )
+                //           (i,j+1) (i+1,j+1)
+
+
+                // if cell is interior
+                if (pic.get(xvec[i]  , yvec[j]  ) == '+' &&
+                    pic.get(xvec[i+1], yvec[j]  ) == '+' &&
+                    pic.get(xvec[i]  , yvec[j+1]) == '+' &&
+                    pic.get(xvec[i+1], yvec[j+1]) == '+') {
+
+                    tokens.push_back(Token::cell(i,j));
+
+                    string cell = "";
+                    for (int k = yvec[j]+1; k < yvec[j+1]; k++) {
+                        for (int l = xvec[i]+1; l < xvec[i+1]; l++) {
+                            cell.push_back(pic.get(l,k));
                         }
-                        parseString(cell, true);
+                        cell.push_back(' ');
                     }
+                    parseString(TextLine(cell), true);
                 }
             }
-            buffer.push(counted_ptr<Token>(new Token(PICTURE_END)));
-
-            for (int j = yt; j <= yvec.back() + yt; j++) {
-                //text[j].erase(xt, xvec.back() + 1);
-                for (int i = xt; i <= xvec.back() + xt; i++) {
-                    text[j][i] = ' ';
-                }
-            }
-
-        } else {
-            push_token(ERROR);
-            for (int j = yvec.front(); j <= yvec.back(); j++)
-                //text[j].erase(xvec.front(), xvec.back() - xvec.front() + 1);
-                for (int i = xvec.front(); i <= xvec.back(); i++) {
-                    text[j][i] = ' ';
-                }
         }
+        tokens.push_back(Token(PICTURE_END));
     }
 
 };
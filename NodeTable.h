@@ -0,0 +1,179 @@
+#ifndef _NODE_TABLE_H_
+#define _NODE_TABLE_H_
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include "arena_ptr.h"
+#include "Fnv.h"
+#include "Set.h"
+#include "Term.h"
+#include "BasicData.h"
+
+using namespace std;
+
+/**
+ * Hash-consing of the sets and terms of a parsed file. Structurally equal
+ * subtrees are replaced by one shared node, numbered by its node id, so
+ * later stages can keep what they computed for a node and reuse it for
+ * every block that contains the same set or term. Sets and terms are
+ * numbered separately; the empty set is node 0.
+ */
+class NodeTable {
+public:
+	NodeTable() : setCount(1), termCount(0) { }
+
+	// shares every set and term of the file, in the order of the file
+	void shareAll(CellFile & file) {
+		sharePicture(file.head.getCell());
+		vector<Expression> & expressions = file.head.getExpressions();
+		for (int i = 0; i < expressions.size(); i++) {
+			expressions[i].setLeft(share(expressions[i].getLeft()));
+			expressions[i].setRight(share(expressions[i].getRight()));
+		}
+		for (int i = 0; i < file.blocks.size(); i++) {
+			Block & block = file.blocks[i];
+			sharePicture(block.getLeft().getSource());
+			sharePicture(block.getRight());
+			vector<Constraint> & constraints = block.getConstraints();
+			for (int j = 0; j < constraints.size(); j++) {
+				constraints[j].setLeft(share(constraints[j].getLeft()));
+				constraints[j].setRight(share(constraints[j].getRight()));
+			}
+		}
+	}
+
+	// the shared node equal to set, its children are shared on the way
+	arena_ptr<Set> share(arena_ptr<Set> set) {
+		if (!set.get() || set->getNodeId() >= 0) return set;
+		vector<int> key;
+		key.push_back(set->getType());
+		switch (set->getType()) {
+		case SET_IDENTIFIER:	key.push_back(static_cast<SetIdentifier*>(set.get())->getName()); break;
+		case SET_RANGE:			key.push_back(static_cast<SetRange*>(set.get())->getFirst());
+								key.push_back(static_cast<SetRange*>(set.get())->getLast()); break;
+		case SET_ENUM:		{
+								SetList * list = static_cast<SetList*>(set.get());
+								key.push_back(list->getNumbers().size());
+								key.insert(key.end(), list->getNumbers().begin(), list->getNumbers().end());
+								key.insert(key.end(), list->getIdentifiers().begin(), list->getIdentifiers().end());
+								break;
+							}
+		case SET_STATEMENT:	{
+								SetStatement * statement = static_cast<SetStatement*>(set.get());
+								arena_ptr<Set> left = share(statement->getLeft()), right = share(statement->getRight());
+								statement->setOperands(left, right);
+								key.push_back(statement->getOp());
+								key.push_back(left.get() ? left->getNodeId() : -1);
+								key.push_back(right.get() ? right->getNodeId() : -1);
+								break;
+							}
+		default: break;
+		}
+		unordered_map<vector<int>, arena_ptr<Set>, KeyHash>::iterator it = sets.find(key);
+		if (it != sets.end()) return it->second;
+		set->setNodeId(setCount++);
+		sets[key] = set;
+		return set;
+	}
+
+	arena_ptr<Term> share(arena_ptr<Term> term) {
+		if (!term.get() || term->getNodeId() >= 0) return term;
+		vector<int> key;
+		key.push_back(term->getType());
+		if (term->getType() == T_STATEMENT) {
+			TermStatement * statement = static_cast<TermStatement*>(term.get());
+			arena_ptr<Term> left = share(statement->getLeft()), right = share(statement->getRight());
+			statement->setOperands(left, right);
+			key.push_back(statement->getOp());
+			key.push_back(left.get() ? left->getNodeId() : -1);
+			key.push_back(right.get() ? right->getNodeId() : -1);
+		} else key.push_back(static_cast<TermIdentNumber*>(term.get())->getIdentName());
+		unordered_map<vector<int>, arena_ptr<Term>, KeyHash>::iterator it = terms.find(key);
+		if (it != terms.end()) return it->second;
+		term->setNodeId(termCount++);
+		terms[key] = term;
+		return term;
+	}
+
+	/**
+	 * Equal for blocks that match the same instances and give the same result,
+	 * whichever symmetry they were made by. Sets and terms have to be shared.
+	 * The left picture is keyed by its non empty cells relative to the main
+	 * cell, a view padded to whole cells keys as the picture it shows.
+	 */
+	vector<int> key(Block & block) {
+		vector<int> key;
+		key.push_back(block.getElse());
+		const SymmetryView & left = block.getLeft();
+		int x0 = left.getWidth(), y0 = left.getHeight(), x1 = -1, y1 = -1;
+		for (int y = 0; y < left.getHeight(); y++)
+			for (int x = 0; x < left.getWidth(); x++) {
+				if (left.get(x,y)->getType() == EMPTY) continue;
+				x0 = min(x0, x); x1 = max(x1, x);
+				y0 = min(y0, y); y1 = max(y1, y);
+			}
+		if (x1 < 0) x0 = y0 = 0;
+		key.push_back(x0 - block.getX());
+		key.push_back(y0 - block.getY());
+		key.push_back(x1 - x0 + 1);
+		key.push_back(y1 - y0 + 1);
+		for (int y = y0; y <= y1; y++)
+			for (int x = x0; x <= x1; x++) addCell(key, left.get(x,y));
+		arena_ptr<Picture<arena_ptr<CellStatement>>> right = block.getRight();
+		key.push_back(right->getWidth());
+		key.push_back(right->getHeight());
+		for (int y = 0; y < right->getHeight(); y++)
+			for (int x = 0; x < right->getWidth(); x++) addCell(key, right->get(x,y));
+		vector<Constraint> & constraints = block.getConstraints();
+		for (int i = 0; i < constraints.size(); i++) {
+			key.push_back(constraints[i].getOp());
+			key.push_back(constraints[i].getLeft().get() ? constraints[i].getLeft()->getNodeId() : -1);
+			key.push_back(constraints[i].getRight().get() ? constraints[i].getRight()->getNodeId() : -1);
+		}
+		return key;
+	}
+
+	int getSetCount() {
+		return setCount;
+	}
+
+	int getTermCount() {
+		return termCount;
+	}
+
+	// FNV-1a over the ints of a key
+	struct KeyHash {
+		size_t operator()(const vector<int> & key) const {
+			unsigned int h = Fnv::offset32;
+			for (int i = 0; i < key.size(); i++) h = Fnv::step32(h, (unsigned int)key[i]);
+			return h;
+		}
+	};
+
+private:
+	unordered_map<vector<int>, arena_ptr<Set>, KeyHash> sets;
+	unordered_map<vector<int>, arena_ptr<Term>, KeyHash> terms;
+	int setCount, termCount;
+
+	void addCell(vector<int> & key, arena_ptr<CellStatement> cell) {
+		CellStatementType type = cell->getType();
+		key.push_back(type);
+		// the number is only set for these
+		if (type == CELL_NUMBER || type == CELL_IDENTIFIER || type == IDENTIFIER_IN_SET) key.push_back(cell->getIdentNumber());
+		key.push_back(cell->getSet().get() ? cell->getSet()->getNodeId() : -1);
+		key.push_back(cell->getTerm().get() ? cell->getTerm()->getNodeId() : -1);
+	}
+
+	void sharePicture(arena_ptr<Picture<arena_ptr<CellStatement>>> pic) {
+		if (!pic.get()) return;
+		for (int y = 0; y < pic->getHeight(); y++)
+			for (int x = 0; x < pic->getWidth(); x++) {
+				arena_ptr<CellStatement> cell = pic->get(x,y);
+				if (cell.get() == CellStatement::empty().get()) continue;
+				cell->setContent(cell->getType(), cell->getIdentNumber(), share(cell->getTerm()), share(cell->getSet()));
+			}
+	}
+};
+
+#endif
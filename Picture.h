@@ -1,57 +1,173 @@
 #ifndef _PICTURE_H_
 #define _PICTURE_H_
 
+#include <utility>
+
+/**
+ * Rectangle of T stored row by row. Pictures of up to 16 elements (a
+ * neighbourhood of 3x3 or 4x4 cells) live inside the object, larger ones
+ * on the heap. get and set check the bounds, get returns the default
+ * outside; row gives unchecked access to a whole row for inner loops.
+ */
 template <class T>
 class Picture {
  public:
 
 	// defaultT = NULL should be used for complex data structures
-	Picture(T defaultT) : defaultT(defaultT) {
-		width = height = 0;
-		contents = new T [1];
-		contents[0] = defaultT;
+	Picture(T defaultT) : defaultT(defaultT), width(0), height(0), capacity(smallSize), contents(small) {
+	}
+
+	Picture(int width, int height, T defaultT) : defaultT(defaultT), width(0), height(0), capacity(smallSize), contents(small) {
+		setSize(width, height);
 	}
-  
-	Picture(int width, int height, T defaultT) : width(width), height(height), defaultT(defaultT) {
-		contents = new T [width * height];
-		for (int i = 0; i < width*height ; i++) contents[i]= defaultT;
+
+	Picture(const Picture & other) : defaultT(other.defaultT), width(0), height(0), capacity(smallSize), contents(small) {
+		*this = other;
+	}
+
+	Picture(Picture && other) : defaultT(other.defaultT), width(0), height(0), capacity(smallSize), contents(small) {
+		*this = std::move(other);
+	}
+
+	Picture & operator=(const Picture & other) {
+		if (this == &other) return *this;
+		defaultT = other.defaultT;
+		reserve(other.width * other.height);
+		width = other.width;
+		height = other.height;
+		for (int i = 0; i < width * height; i++) contents[i] = other.contents[i];
+		return *this;
+	}
+
+	Picture & operator=(Picture && other) {
+		if (this == &other) return *this;
+		if (other.contents != other.small) {
+			// take over the heap storage
+			release();
+			contents = other.contents;
+			capacity = other.capacity;
+			other.contents = other.small;
+			other.capacity = smallSize;
+		} else {
+			reserve(other.width * other.height);
+			for (int i = 0; i < other.width * other.height; i++) contents[i] = std::move(other.contents[i]);
+		}
+		defaultT = other.defaultT;
+		width = other.width;
+		height = other.height;
+		other.width = other.height = 0;
+		return *this;
 	}
 
 	~Picture() {
-		delete [] contents; //why is this throwing Es
+		release();
 	}
-  
+
 	int getWidth() const {
 		return width;
 	}
-  
+
 	int getHeight() const {
 		return height;
 	}
-  
+
+	// all elements are reset to the default, storage is only reallocated to grow
 	void setSize(int width, int height) {
-		delete [] contents;
+		reserve(width * height);
 		this->width  = width;
 		this->height = height;
-		contents = new T [width * height];
 		for (int i = 0; i < width*height ; i++) contents[i] = defaultT;
 	}
-  
-	const T get(int i, int j) {
-		if ((0 <= i) && (i < width) && (0 <= j) && (j < height)) 
+
+	const T & get(int i, int j) const {
+		if ((0 <= i) && (i < width) && (0 <= j) && (j < height))
 			return contents[i + j * width];
 		else return defaultT;
 	}
-  
+
 	void set(int i, int j, T content) {
-		if ((0 <= i) && (i < width) && (0 <= j) && (j < height)) 
+		if ((0 <= i) && (i < width) && (0 <= j) && (j < height))
 			contents[i + j * width] = content;
 	}
 
+	// unchecked, row j holds the elements (0, j) ... (width - 1, j)
+	T * row(int j) {
+		return contents + j * width;
+	}
+
+	const T * row(int j) const {
+		return contents + j * width;
+	}
+
 private:
-	T * contents;
+	static const int smallSize = 16;
+
 	T defaultT;
 	int width, height;
+	int capacity;
+	T * contents;
+	T small[smallSize];
+
+	void reserve(int size) {
+		if (size <= capacity) return;
+		release();
+		contents = new T [size];
+		capacity = size;
+	}
+
+	void release() {
+		if (contents != small) delete [] contents;
+		contents = small;
+		capacity = smallSize;
+	}
+};
+
+/**
+ * Picture whose size is known at compile time, kept entirely inside the
+ * object. Same access as Picture but without setSize.
+ */
+template <class T, int W, int H>
+class FixedPicture {
+ public:
+	FixedPicture(T defaultT) : defaultT(defaultT) {
+		for (int i = 0; i < W*H; i++) contents[i] = defaultT;
+	}
+
+	int getWidth() const {
+		return W;
+	}
+
+	int getHeight() const {
+		return H;
+	}
+
+	// resets all elements to the default
+	void clear() {
+		for (int i = 0; i < W*H; i++) contents[i] = defaultT;
+	}
+
+	const T & get(int i, int j) const {
+		if ((0 <= i) && (i < W) && (0 <= j) && (j < H))
+			return contents[i + j * W];
+		else return defaultT;
+	}
+
+	void set(int i, int j, T content) {
+		if ((0 <= i) && (i < W) && (0 <= j) && (j < H))
+			contents[i + j * W] = content;
+	}
+
+	T * row(int j) {
+		return contents + j * W;
+	}
+
+	const T * row(int j) const {
+		return contents + j * W;
+	}
+
+private:
+	T defaultT;
+	T contents[W*H];
 };
 
 #endif
\ No newline at end of file
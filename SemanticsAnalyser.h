@@ -11,12 +11,12 @@
 #include "Lexer.h"
 #include "Set.h"
 #include "BasicData.h"
-#include "Variable.h"
+#include "SymbolTable.h"
 
 class SemanticsAnalyser {
 public:
-    SemanticsAnalyser(map<int, counted_ptr<Variable> > & varTable)
-        : varTable(varTable), posSet(counted_ptr<Set>(new Set())) { }
+    SemanticsAnalyser(SymbolTable & varTable)
+        : varTable(varTable), posSet(Set::empty()) { }
 
     bool analyseProgram(CellFile & program) {
         if (!analyseHead(program.head)) return false;
@@ -26,8 +26,8 @@ public:
             if (program.noPointer &&
                 program.blocks[i].getX() > cellX ||
                 program.blocks[i].getY() > cellY ||
-                program.blocks[i].getLeft()->getWidth() - program.blocks[i].getX() - cellX > cellX ||
-                program.blocks[i].getLeft()->getHeight() - program.blocks[i].getY() - cellY > cellY) {
+                program.blocks[i].getLeft().getWidth() - program.blocks[i].getX() - cellX > cellX ||
+                program.blocks[i].getLeft().getHeight() - program.blocks[i].getY() - cellY > cellY) {
                 error << "Error: the described cellular automaton accesses cells not in his neighborhood. This is not possible without pointers. It will be continued with pointers." << endl;
                 program.noPointer = false;
             }
@@ -40,14 +40,14 @@ public:
     }
 
 private:
-    map<int, counted_ptr<Variable> > & varTable;
+    SymbolTable & varTable;
     stringstream error;
     int cellX, cellY;
 
     /**
      * Contains what values can be in sets for each subcell.
      */
-    Picture<counted_ptr<Set> > posSet;
+    Picture<arena_ptr<Set> > posSet;
 
     bool analyseHead(Head & head) {
         cellX = head.getCell()->getWidth();
@@ -94,13 +94,11 @@ private:
             return false;
         }
 
-        varTable[static_cast<SetIdentifier *>(expr.getLeft().get())->getName()]
-                = counted_ptr<Variable>(new VariableSet(expr.getRight()));
+        varTable.defineSet(static_cast<SetIdentifier *>(expr.getLeft().get())->getName(), expr.getRight());
 
         if (!analyseSet(expr.getRight())) {
             error << "Error: an error ocurred while analysing the right side of an expression in the head" << endl;
-            varTable[static_cast<SetIdentifier *>(expr.getLeft().get())->getName()]
-                = counted_ptr<Variable>();
+            varTable.undefine(static_cast<SetIdentifier *>(expr.getLeft().get())->getName());
             return false;
         }
 
@@ -109,11 +107,10 @@ private:
 
 
     // Should only be called for sets in header since it automatically labels every identifier it finds inside {..} a constant set content
-    bool analyseSet(counted_ptr<Set> set) {
+    bool analyseSet(arena_ptr<Set> set) {
 
         if (set->getType() == SET_IDENTIFIER) {
-            counted_ptr<Variable> var = varTable[static_cast<SetIdentifier*>(set.get())->getName()];
-            if (!var.get() || var->getType() != VAR_SET) {
+            if (!varTable.is(static_cast<SetIdentifier*>(set.get())->getName(), VAR_SET)) {
                 error << "Error: expected a set instead found an identifier not connected to a set" << endl;
                 return false;
             }
@@ -127,8 +124,8 @@ private:
             vector<int> & vec = static_cast<SetList*>(set.get())->getIdentifiers();
 
             for (int i = 0; i < vec.size(); i++) {
-                if (! (varTable[vec[i]].get())) varTable[vec[i]] = counted_ptr<Variable>(new Variable(SET_CONTENT));
-                else if (varTable[vec[i]]->getType() == VAR_SET) {
+                if (!varTable.isDefined(vec[i])) varTable.defineSetContent(vec[i]);
+                else if (varTable.is(vec[i], VAR_SET)) {
                     error << "Error: there is a set inside another set this is not allowed" << endl;
                     return false;
                 }
@@ -141,41 +138,41 @@ private:
 
 
     bool analyseLeftPic(Block & block) {
-        counted_ptr<Picture<counted_ptr<CellStatement>>> pic = block.getLeft();
-        for (int i = 0; i < pic->getWidth() ; i++) {
+        const SymmetryView & pic = block.getLeft();
+        for (int i = 0; i < pic.getWidth() ; i++) {
             int x = (i - block.getX()) % cellX;
             if (x < 0) x += cellX;
 
-            for (int j = 0; j < pic->getHeight(); j++) {
+            for (int j = 0; j < pic.getHeight(); j++) {
                 int y = (j - block.getY()) % cellY;
                 if (y < 0) y += cellY;
 
-                if (pic->get(i,j)->getType() == CELL_NUMBER) {
+                if (pic.get(i,j)->getType() == CELL_NUMBER) {
                     // is this number possible in this cell
-                    if (!numInSet(pic->get(i,j)->getIdentNumber(), posSet.get(x,y))) {
+                    if (!numInSet(pic.get(i,j)->getIdentNumber(), posSet.get(x,y))) {
                         error << "Error: a number on the left side of a block does not fit into its cell" << endl;
                         return false;
                     }
 
-                } else if ((pic->get(i,j)->getType() == CELL_IDENTIFIER)
-                        || (pic->get(i,j)->getType() == IDENTIFIER_IN_SET)) {
+                } else if ((pic.get(i,j)->getType() == CELL_IDENTIFIER)
+                        || (pic.get(i,j)->getType() == IDENTIFIER_IN_SET)) {
 
-                    auto identNum = pic->get(i,j)->getIdentNumber();
-                    if (!(varTable[identNum].get())) {
+                    auto identNum = pic.get(i,j)->getIdentNumber();
+                    if (!varTable.isDefined(identNum)) {
                         // never before seen identifier musst be local variable
-                        varTable[identNum] = counted_ptr<Variable>(new VariableContent());
+                        varTable.defineContent(identNum);
                     }
 
-                    if ((varTable[identNum]->getType() == VAR_CONTENT)) {
-                        auto varContent = static_cast<VariableContent*>(varTable[pic->get(i,j)->getIdentNumber()].get());
-                        if (!(varContent->defInBlock(block.getBlockIdent()))) {
+                    if ((varTable.is(identNum, VAR_CONTENT))) {
+                        VariableContent & varContent = varTable.getContent(identNum);
+                        if (!(varContent.defInBlock(block.getBlockIdent()))) {
                             // variable was previously undefined in this block has been seen in another block
                             VariableContent::Koord koord;
                             koord.x = i; koord.y = j;
-                            varContent->setKoord(block.getBlockIdent(), koord);
+                            varContent.setKoord(block.getBlockIdent(), koord);
                         }
 
-                    } else if ((varTable[identNum]->getType() == SET_CONTENT)) {
+                    } else if ((varTable.is(identNum, SET_CONTENT))) {
                         // the identifier is part of a standard set is this identifier possible in this cell
                         if (!identInSet(identNum, posSet.get(x,y))) {
                             error << "Error: an identifier on the left side of a block does not fit into its cell" << endl;
@@ -190,15 +187,15 @@ private:
             }
         }
 
-        for (int i = 0; i < pic->getWidth() ; i++) {
+        for (int i = 0; i < pic.getWidth() ; i++) {
             int x = (i - block.getX()) % cellX;
             if (x < 0) x += cellX;
-            for (int j = 0; j < pic->getHeight(); j++) {
+            for (int j = 0; j < pic.getHeight(); j++) {
                 int y = (j - block.getY()) % cellY;
                 if (y < 0) y += cellY;
-                if (pic->get(i,j)->getType() == CELL_TERM ||
-                    pic->get(i,j)->getType() == TERM_IN_SET) {
-                    if (!analyseTerm(pic->get(i,j)->getTerm(), block)) {
+                if (pic.get(i,j)->getType() == CELL_TERM ||
+                    pic.get(i,j)->getType() == TERM_IN_SET) {
+                    if (!analyseTerm(pic.get(i,j)->getTerm(), block)) {
                         error << "Error: a term in the left picture of a block is not defined completely" << endl;
                         return false;
                     }
@@ -213,7 +210,7 @@ private:
     }
 
     bool analyseRightPic(Block & block) {
-        counted_ptr<Picture<counted_ptr<CellStatement>>> pic = block.getRight();
+        arena_ptr<Picture<arena_ptr<CellStatement>>> pic = block.getRight();
         if ((pic->getWidth() != cellX) || (pic->getHeight() != cellY)) {
             error << "Error: right side has not the right dimensions" << endl;
             return false;
@@ -241,25 +238,25 @@ private:
                 } else if (pic->get(i,j)->getType() == CELL_IDENTIFIER) {
 
                     auto identNum = pic->get(i,j)->getIdentNumber();
-                    if (!(varTable[identNum].get())) {
+                    if (!varTable.isDefined(identNum)) {
                         error << "Error: uninitialized variable on the right side of a block" << endl;
                         return false;
 
-                    } else if (varTable[identNum]->getType() == SET_CONTENT) {
+                    } else if (varTable.is(identNum, SET_CONTENT)) {
                         // is this identifier possible in this cell
                         if (!identInSet(identNum, posSet.get(i,j))) {
                             error << "Error: an identifier on the right side of a block does not fit into its cell" << endl;
                             return false;
                         }
 
-                    } else if (varTable[identNum]->getType() == VAR_CONTENT) {
+                    } else if (varTable.is(identNum, VAR_CONTENT)) {
                         // is this VAR_IDENTIFIER initialized here?
-                        VariableContent* varC = static_cast<VariableContent*>(varTable[identNum].get());
-                        if (!varC->defInBlock(block.getBlockIdent())) {
+                        VariableContent & varC = varTable.getContent(identNum);
+                        if (!varC.defInBlock(block.getBlockIdent())) {
                             error << "Error: uninitialized variable on the right side of a block" << endl;
                             return false;
                         }
-                        VariableContent::Koord k = varC->getKoord(block.getBlockIdent());
+                        VariableContent::Koord k = varC.getKoord(block.getBlockIdent());
                         k.x = (k.x - block.getX() < 0) ? ((k.x - block.getX()) % cellX) + cellX : (k.x - block.getX()) % cellX;
                         k.y = (k.y - block.getY() < 0) ? ((k.y - block.getY()) % cellY) + cellY : (k.y - block.getY()) % cellY;
                         if (isIdentInSet(posSet.get(k.x, k.y)) != isIdentInSet(posSet.get(i,j))) {
@@ -289,7 +286,7 @@ private:
         return true;
     }
 
-    bool analyseTerm(counted_ptr<Term> t, Block & block) {
+    bool analyseTerm(arena_ptr<Term> t, Block & block) {
         if (!t.get()) {
             error << "Error: an empty term" << endl;
             return false;
@@ -298,17 +295,16 @@ private:
         case T_NUMBER:		return true;
         case T_IDENTIFIER:	{
                                 TermIdentNumber* ti = static_cast<TermIdentNumber*>(t.get());
-                                if (!varTable[ti->getIdentName()].get() ||
-                                    varTable[ti->getIdentName()]->getType() != VAR_CONTENT) {
+                                if (!varTable.is(ti->getIdentName(), VAR_CONTENT)) {
                                     error << "Error: identifiers in terms musst be variables" << endl;
                                     return false;
                                 }
-                                VariableContent* vc = static_cast<VariableContent*>(varTable[ti->getIdentName()].get());
-                                if (!vc->defInBlock(block.getBlockIdent())) {
+                                VariableContent & vc = varTable.getContent(ti->getIdentName());
+                                if (!vc.defInBlock(block.getBlockIdent())) {
                                     error << "Error: a variable in a term is not defined in this block" << endl;
                                     return false;
                                 }
-                                VariableContent::Koord k = vc->getKoord(block.getBlockIdent());
+                                VariableContent::Koord k = vc.getKoord(block.getBlockIdent());
                                 k.x = (k.x - block.getX()) % cellX;
                                 k.y = (k.y - block.getY()) % cellY;
                                 k.x = (k.x < 0) ? k.x + cellX : k.x;
@@ -325,10 +321,10 @@ private:
     }
 
     // does not work if VAR_CONTENT are in a Set
-    bool isIdentInSet(counted_ptr<Set> set) {
+    bool isIdentInSet(arena_ptr<Set> set) {
         if (set->getType() == SET_IDENTIFIER) {
             SetIdentifier* s1 = static_cast<SetIdentifier*>(set.get());
-            return isIdentInSet(static_cast<VariableSet*>(varTable[s1->getName()].get())->getSet());
+            return isIdentInSet(varTable.getSet(s1->getName()));
 
         } else if (set->getType() == SET_ENUM) {
             return static_cast<SetList*>(set.get())->getIdentifiers().size();
@@ -350,10 +346,10 @@ private:
 
     // does not work if VAR_SET_CONTENTs are in a Set should only be tested to check if SET_CONENT possible in a cell
     // set has to be initialized
-    bool identInSet(int ident, counted_ptr<Set> set) {
+    bool identInSet(int ident, arena_ptr<Set> set) {
         if (set->getType() == SET_IDENTIFIER) {
             SetIdentifier* s1 = static_cast<SetIdentifier*>(set.get());
-            return identInSet(ident, static_cast<VariableSet*>(varTable[s1->getName()].get())->getSet());
+            return identInSet(ident, varTable.getSet(s1->getName()));
 
         } else if (set->getType() == SET_ENUM) {
             vector<int> identVec = static_cast<SetList*>(set.get())->getIdentifiers();
@@ -373,10 +369,10 @@ private:
         return false;
     }
 
-    bool numInSet(int num, counted_ptr<Set> set) {
+    bool numInSet(int num, arena_ptr<Set> set) {
         if (set->getType() == SET_IDENTIFIER) {
             SetIdentifier* s1 = static_cast<SetIdentifier*>(set.get());
-            return numInSet(num, static_cast<VariableSet*>(varTable[s1->getName()].get())->getSet());
+            return numInSet(num, varTable.getSet(s1->getName()));
 
         } else if (set->getType() == SET_ENUM) {
             vector<int> numVec = static_cast<SetList*>(set.get())->getNumbers();
@@ -3,7 +3,7 @@
 
 #include "Token.h"
 #include <vector>
-#include "counted_ptr.h"
+#include "arena_ptr.h"
 
 enum SetOperation {
 	UNION, //+
@@ -21,16 +21,32 @@ enum SetType {
 
 class Set { //Identifier
 public:	
-	Set() : type(SET_EMPTY) {}
-	Set(SetType type) : type(type) {}
-	virtual ~Set() {}
+	// the empty set is always node 0
+	Set() : type(SET_EMPTY), nodeId(0) {}
+	Set(SetType type) : type(type), nodeId(-1) {}
+
+	// shared by everyone who needs an empty set, never changed
+	static arena_ptr<Set> empty() {
+		static Set emptySet;
+		return arena_ptr<Set>(&emptySet);
+	}
 	
 	SetType getType() {
 		return type;
 	}
 
+	// equal for structurally equal sets once they went through a NodeTable, -1 before
+	int getNodeId() {
+		return nodeId;
+	}
+
+	void setNodeId(int id) {
+		nodeId = id;
+	}
+
 private:
 	SetType type;
+	int nodeId;
 };
 
 class SetIdentifier : public Set {
@@ -85,14 +101,14 @@ private:
 
 class SetStatement : public Set {
 public:
-	SetStatement (counted_ptr<Set> pleft, counted_ptr<Set> pright, SetOperation op) 
+	SetStatement (arena_ptr<Set> pleft, arena_ptr<Set> pright, SetOperation op) 
 		: Set(SET_STATEMENT), op(op), right(pright), left(pleft) { }
 
-	counted_ptr<Set> getLeft() {
+	arena_ptr<Set> getLeft() {
 		return left;
 	}
 
-	counted_ptr<Set> getRight() {
+	arena_ptr<Set> getRight() {
 		return right;
 	}
 
@@ -100,9 +116,14 @@ public:
 		return op;
 	}
 
+	void setOperands(arena_ptr<Set> pleft, arena_ptr<Set> pright) {
+		left = pleft;
+		right = pright;
+	}
+
 private:
-	counted_ptr<Set> left;
-	counted_ptr<Set> right;
+	arena_ptr<Set> left;
+	arena_ptr<Set> right;
 	SetOperation op;
 };
 
@@ -2,42 +2,90 @@
 #define _STR_TABLE_H_
 
 #include <cstdlib>
-#include <map>
+#include <cstring>
 #include <string>
+#include <vector>
+#include "Fnv.h"
 
 using namespace std;
 
+/**
+ * Numbers identifiers from 1 on. The strings are kept one after the other in
+ * a single character pool, each followed by '\0', and found again through an
+ * open addressing hash of their numbers; the number indexes the offset of
+ * its string in the pool.
+ */
 class StringTable {
 public:
 	
-	StringTable() : counter(1){
+	StringTable() : slots(64, 0), offsets(1, 0), lengths(1, 0), hashes(1, 0) {
+		pool.push_back('\0'); // number 0 is no identifier, it reads as ""
 	}
 
-	int getIdentity(string str) {
-		if(table[str] == 0) {
-			table[str] = counter;
-			revTable[counter] = str;
-			counter++;
+	// str must not point into this table's pool
+	int getIdentity(const char * str, int length) {
+		unsigned int h = hash(str, length);
+		int mask = slots.size() - 1;
+		int i = h & mask;
+		for (; slots[i] != 0; i = (i + 1) & mask) {
+			int ident = slots[i];
+			if (hashes[ident] == h && lengths[ident] == length
+				&& memcmp(&pool[offsets[ident]], str, length) == 0) return ident;
 		}
-		return table[str];
+		int ident = offsets.size();
+		offsets.push_back(pool.size());
+		lengths.push_back(length);
+		hashes.push_back(h);
+		pool.insert(pool.end(), str, str + length);
+		pool.push_back('\0');
+		slots[i] = ident;
+		if (2 * size() > slots.size()) grow();
+		return ident;
 	}
 
-	string getString(int ident) {
-		return revTable[ident];
+	int getIdentity(const string & str) {
+		return getIdentity(str.data(), str.size());
 	}
 
-	int size() {
-		return counter - 1;
+	// valid until the next new identifier, "" for unknown numbers
+	const char * getString(int ident) const {
+		if (ident <= 0 || ident >= offsets.size()) return &pool[0];
+		return &pool[offsets[ident]];
+	}
+
+	int getLength(int ident) const {
+		if (ident <= 0 || ident >= offsets.size()) return 0;
+		return lengths[ident];
+	}
+
+	int size() const {
+		return offsets.size() - 1;
 	}
 
 private:
-	map<string, int> table; // would have to be changed to incorporate namespaces 
-							// instead of just int use int and namespace identifier of some kind
-							// or maybe even multiple StringTables for different namespaces
-	map<int, string> revTable;
+	vector<int> slots;           // numbers by hash, 0 is free, the size is a power of two
+	vector<char> pool;
+	vector<int> offsets;         // by number
+	vector<int> lengths;         // by number
+	vector<unsigned int> hashes; // by number, so growing does not rehash the strings
 
+	// FNV-1a
+	static unsigned int hash(const char * str, int length) {
+		unsigned int h = Fnv::offset32;
+		for (int i = 0; i < length; i++) h = Fnv::step32(h, (unsigned char)str[i]);
+		return h;
+	}
 
-	int counter;
+	void grow() {
+		vector<int> bigger(2 * slots.size(), 0);
+		int mask = bigger.size() - 1;
+		for (int ident = 1; ident < offsets.size(); ident++) {
+			int i = hashes[ident] & mask;
+			while (bigger[i] != 0) i = (i + 1) & mask;
+			bigger[i] = ident;
+		}
+		slots.swap(bigger);
+	}
 };
 
 
@@ -0,0 +1,100 @@
+#ifndef _SYMBOL_TABLE_H_
+#define _SYMBOL_TABLE_H_
+
+#include <string>
+#include <vector>
+#include "Variable.h"
+
+using namespace std;
+
+/**
+ * What the identifiers of a rule file stand for, indexed by the numbers the
+ * StringTable gave them. Looking up an identifier never defines it; the
+ * records of sets and local variables are kept by type, so getSet and
+ * getContent need no cast. References returned stay valid until the next
+ * definition.
+ */
+class SymbolTable {
+public:
+	SymbolTable() { }
+
+	bool isDefined(int ident) const {
+		return ident >= 0 && ident < symbols.size() && symbols[ident].defined;
+	}
+
+	// false for undefined identifiers
+	bool is(int ident, VariableType type) const {
+		return isDefined(ident) && symbols[ident].type == type;
+	}
+
+	// the identifier has to be defined
+	VariableType getType(int ident) const {
+		return symbols[ident].type;
+	}
+
+	void defineSet(int ident, arena_ptr<Set> set) {
+		define(ident, VAR_SET, sets.size());
+		sets.push_back(VariableSet(set));
+	}
+
+	void defineSetContent(int ident) {
+		define(ident, SET_CONTENT, -1);
+	}
+
+	VariableContent & defineContent(int ident) {
+		define(ident, VAR_CONTENT, contents.size());
+		contents.push_back(VariableContent());
+		return contents.back();
+	}
+
+	void undefine(int ident) {
+		if (isDefined(ident)) symbols[ident].defined = false;
+	}
+
+	// the set a VAR_SET identifier was defined with
+	arena_ptr<Set> getSet(int ident) {
+		return sets[symbols[ident].index].getSet();
+	}
+
+	// the record of a VAR_CONTENT identifier
+	VariableContent & getContent(int ident) {
+		return contents[symbols[ident].index];
+	}
+
+	string print(int ident) const {
+		if (!isDefined(ident)) return "undefined";
+		switch (symbols[ident].type) {
+		case VAR_SET:		return "var set";
+		case SET_CONTENT:	return "set content";
+		case VAR_CONTENT:	return "var set content";
+		default:			return "variable without type";
+		}
+	}
+
+	// one more than the highest identifier ever defined
+	int size() const {
+		return symbols.size();
+	}
+
+private:
+	struct Symbol {
+		bool defined;
+		VariableType type;
+		int index; // into sets or contents
+	};
+
+	vector<Symbol> symbols;
+	vector<VariableSet> sets;
+	vector<VariableContent> contents;
+
+	void define(int ident, VariableType type, int index) {
+		if (ident >= symbols.size()) {
+			Symbol none = {false, VAR_SET, -1};
+			symbols.resize(ident + 1, none);
+		}
+		Symbol symbol = {true, type, index};
+		symbols[ident] = symbol;
+	}
+};
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef _SYMMETRY_VIEW_H_
+#define _SYMMETRY_VIEW_H_
+
+#include <cmath>
+#include "arena_ptr.h"
+#include "Picture.h"
+
+class CellStatement;
+
+enum Symmetry {
+	SYM_IDENTITY,
+	SYM_TURN_90,
+	SYM_TURN_180,
+	SYM_TURN_270,
+	SYM_MIRROR_X,
+	SYM_MIRROR_Y
+};
+
+/**
+ * The left picture of a block seen turned or mirrored around its main cell.
+ * Nothing is copied, coordinates are mapped on every access. The picture is
+ * moved in whole cells of the head's size while the content of a cell keeps
+ * its orientation.
+ */
+class SymmetryView {
+public:
+	SymmetryView() : symmetry(SYM_IDENTITY), xMain(0), yMain(0) { }
+
+	// the source has to be complete, its size is read once here
+	SymmetryView(arena_ptr<Picture<arena_ptr<CellStatement>>> source, Symmetry symmetry, int xMain, int yMain, int cellX, int cellY)
+		: source(source), symmetry(symmetry), xMain(xMain), yMain(yMain), cellX(cellX), cellY(cellY) {
+		if (symmetry == SYM_IDENTITY) return;
+		// cells left of, right of (main included), above and below (main included) the main cell
+		left  = ceil(((float)xMain)/cellX);
+		right = ceil(((float)source->getWidth() - xMain)/cellX);
+		up    = ceil(((float)yMain)/cellY);
+		down  = ceil(((float)source->getHeight() - yMain)/cellY);
+		x0 = xMain - left * cellX;
+		y0 = yMain - up * cellY;
+		switch (symmetry) {
+		case SYM_TURN_90:	set(cellX*(up+down), cellY*(left+right), up*cellX, (right-1)*cellY); break;
+		case SYM_TURN_180:	set(cellX*(left+right), cellY*(up+down), (right-1)*cellX, (down-1)*cellY); break;
+		case SYM_TURN_270:	set(cellX*(up+down), cellY*(left+right), (down-1)*cellX, left*cellY); break;
+		case SYM_MIRROR_X:	set(cellX*(left+right), cellY*(up+down), (right-1)*cellX, up*cellY); break;
+		case SYM_MIRROR_Y:	set(cellX*(left+right), cellY*(up+down), left*cellX, (down-1)*cellY); break;
+		default: break;
+		}
+	}
+
+	Symmetry getSymmetry() const {
+		return symmetry;
+	}
+
+	// the picture as parsed, shared by all views of one block
+	arena_ptr<Picture<arena_ptr<CellStatement>>> getSource() const {
+		return source;
+	}
+
+	int getWidth() const {
+		return (symmetry == SYM_IDENTITY) ? source->getWidth() : width;
+	}
+
+	int getHeight() const {
+		return (symmetry == SYM_IDENTITY) ? source->getHeight() : height;
+	}
+
+	// the main cell in view coordinates
+	int getX() const {
+		return (symmetry == SYM_IDENTITY) ? xMain : x;
+	}
+
+	int getY() const {
+		return (symmetry == SYM_IDENTITY) ? yMain : y;
+	}
+
+	const arena_ptr<CellStatement> & get(int i, int j) const {
+		if (symmetry == SYM_IDENTITY) return source->get(i, j);
+		if ((i < 0) || (i >= width) || (j < 0) || (j >= height)) return source->get(-1, -1);
+		// the cell (a, b) of the view shows the cell (sa, sb) of the source
+		int a(i / cellX), b(j / cellY), sa, sb;
+		switch (symmetry) {
+		case SYM_TURN_90:	sa = left+right-1-b;	sb = a;				break;
+		case SYM_TURN_180:	sa = left+right-1-a;	sb = up+down-1-b;	break;
+		case SYM_TURN_270:	sa = b;					sb = up+down-1-a;	break;
+		case SYM_MIRROR_X:	sa = left+right-1-a;	sb = b;				break;
+		default:			sa = a;					sb = up+down-1-b;	break;
+		}
+		return source->get(x0 + sa*cellX + i % cellX, y0 + sb*cellY + j % cellY);
+	}
+
+private:
+	arena_ptr<Picture<arena_ptr<CellStatement>>> source;
+	Symmetry symmetry;
+	int xMain, yMain, cellX, cellY;
+	int left, right, up, down, x0, y0;
+	int width, height, x, y;
+
+	void set(int w, int h, int xm, int ym) {
+		width = w; height = h; x = xm; y = ym;
+	}
+};
+
+#endif
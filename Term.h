@@ -1,7 +1,7 @@
 #ifndef _TERM_H_
 #define _TERM_H_
 
-#include "counted_ptr.h"
+#include "arena_ptr.h"
 
 enum TermOperation {
 	OP_PLUS,
@@ -19,15 +19,24 @@ enum TermType {
 
 class Term {
 public:	
-	Term(TermType type) : type(type) {}
-	virtual ~Term() {}
+	Term(TermType type) : type(type), nodeId(-1) {}
 	
 	TermType getType() {
 		return type;
 	}
 
+	// equal for structurally equal terms once they went through a NodeTable, -1 before
+	int getNodeId() {
+		return nodeId;
+	}
+
+	void setNodeId(int id) {
+		nodeId = id;
+	}
+
 private:
 	TermType type;
+	int nodeId;
 };
 
 class TermIdentNumber : public Term {
@@ -45,14 +54,14 @@ private:
 
 class TermStatement : public Term {
 public:
-	TermStatement (counted_ptr<Term> pleft, counted_ptr<Term> pright, TermOperation op) 
+	TermStatement (arena_ptr<Term> pleft, arena_ptr<Term> pright, TermOperation op) 
 		: Term(T_STATEMENT), op(op), right(pright), left(pleft) { }
 
-	counted_ptr<Term> getLeft() {
+	arena_ptr<Term> getLeft() {
 		return left;
 	}
 
-	counted_ptr<Term> getRight() {
+	arena_ptr<Term> getRight() {
 		return right;
 	}
 
@@ -60,9 +69,14 @@ public:
 		return op;
 	}
 
+	void setOperands(arena_ptr<Term> pleft, arena_ptr<Term> pright) {
+		left = pleft;
+		right = pright;
+	}
+
 private:
-	counted_ptr<Term> left;
-	counted_ptr<Term> right;
+	arena_ptr<Term> left;
+	arena_ptr<Term> right;
 	TermOperation op;
 };
 
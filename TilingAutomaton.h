@@ -23,7 +23,7 @@ class TilingAutomaton {
 		"dddd", "|d+d", "|d|d", /*"+-|d",*/ "+d|d", "--dd", "+-dd", "-+dd", "d###", "dd##", "d#d#", "+#d#", "+d##", "+ddd",
 		"+-|y", "-+y|", "|y+-", "y|-+", "--yx", "yxxx", "|y|x", "yx--", "y|x|",
 		"+-|z", "--zz", "|z|z", "zzzz", "-+zd", "|z+d", "zzdd", "zdzd", "zddd", "-+z|", "|z+-", "zz--", "z|z|", "z|-+", "--zy", "zy--", "|z|y", "z|y|", "zyyy"};
-		tiles = new TileTree(standardTiles, 107);
+		map<char, string> pi;
 		pi['#']="#";
 		pi['+']="+";
 		pi['-']="-";
@@ -35,64 +35,92 @@ class TilingAutomaton {
 		pi['b']=" ";
 		pi['c']=" ";
 		pi['d']=" ";
+		compile(standardTiles, 107, pi);
 	}
 
 	TilingAutomaton(string tileStrings[], int tilesLength, char orderedAlphabet[], int alphabetLength, string piInAlphabetsOrder[]) {
-		tiles = new TileTree(tileStrings, tilesLength);
+		map<char, string> pi;
 		for(int i = 0; i < alphabetLength; i++) pi[orderedAlphabet[i]]=piInAlphabetsOrder[i];
+		compile(tileStrings, tilesLength, pi);
 	}
 
-	~TilingAutomaton() {
-		delete tiles;
-	}
+	// P only needs getWidth(), getHeight() and get(i, j) like Picture<char>
+	template <class P>
+	bool testPicture(P * pic) {
+		int width = pic->getWidth();
+		vector<unsigned char> upper(width, border), lower(width, border);
 
-	bool testPicture(Picture<char> * pic) {
-		Picture<char> tempPic = Picture<char>(pic->getWidth(), 2, '#');
-		
-		string tStr;
 		// Possibly make own class for scanning strategy
 		for(int j = 0; j < pic->getHeight(); j++) {
-			for(int i = 0; i < pic->getWidth(); i++) {
-				tStr.clear();
-				tStr.push_back(tempPic.get(i-1,0));
-				tStr.push_back(tempPic.get(i,0));
-				tStr.push_back(tempPic.get(i-1,1));
-				string ttStr = tiles->getPossibleEndings(tStr,0);
-				int sign = -1;
-				for (int k = 0; k < ttStr.size(); k++) {
-					if (pi[ttStr[k]].find(pic->get(i, j)) < pi[ttStr[k]].size()) sign = k;
-				}
-				if (sign >= 0) tempPic.set(i,1, ttStr[sign]);
-				else return false;
-				/*else {
-					ofstream outStream;
-					outStream.open("outTAuto.txt");
-					outStream << "Position: " << i << ","<< j << endl;
-					outStream << "Symbol: " << pic->get(i, j) << endl;
-					outStream << "Tile: " << tStr << " possibilities: " << ttStr << endl;
-					for (int i = 0; i < tempPic.getHeight(); i++) {
-						for (int j = 0; j < tempPic.getWidth(); j++) {
-							outStream << tempPic.get(j,i);
-						}
-						outStream << endl;
-					}
-					outStream.close();
-					return false;
-				}//*/
-			}
-			for (int i = 0; i < tempPic.getWidth(); i++) {
-				tempPic.set(i,0, tempPic.get(i, 1));
-				tempPic.set(i,1,'#');
+			for(int i = 0; i < width; i++) {
+				int upLeft = (i > 0) ? upper[i-1] : border;
+				int left = (i > 0) ? lower[i-1] : border;
+				unsigned char next = table[((upLeft * nStates + upper[i]) * nStates + left) * nClasses
+					+ byteClass[static_cast<unsigned char>(pic->get(i, j))]];
+				if (next == 0) return false;
+				lower[i] = next - 1;
 			}
+			upper.swap(lower);
+			fill(lower.begin(), lower.end(), border);
 		}
 
 		return true;
 	}
 	
 private:
-	TileTree * tiles;
-	// stores the projection pi which is used in the theory of 2D languages
-	map<char, string> pi;
+	int nStates, nClasses;
+	unsigned char border;
+	unsigned char byteClass[256];
+	// indexed by (up-left, up, left) state and class of the input byte,
+	// holds the resulting state + 1 or 0 if the picture is rejected
+	vector<unsigned char> table;
+
+	/**
+	 * Turns the tiles and the projection pi into the flat transition table.
+	 * The states are the symbols of the tiles, input bytes with the same
+	 * preimages under pi share a class.
+	 */
+	void compile(string tileStrings[], int tilesLength, map<char, string> & pi) {
+		string states = "#";
+		for (int i = 0; i < tilesLength; i++)
+			for (int k = 0; k < tileStrings[i].size(); k++)
+				if (states.find(tileStrings[i][k]) == string::npos) states.push_back(tileStrings[i][k]);
+		nStates = states.size();
+		border = 0;
+
+		map<vector<bool>, int> classes;
+		vector<int> representative;
+		for (int c = 0; c < 256; c++) {
+			vector<bool> preimage(nStates);
+			for (int k = 0; k < nStates; k++) preimage[k] = pi[states[k]].find(static_cast<char>(c)) != string::npos;
+			if (!classes.count(preimage)) {
+				classes[preimage] = representative.size();
+				representative.push_back(c);
+			}
+			byteClass[c] = classes[preimage];
+		}
+		nClasses = representative.size();
+
+		TileTree tiles(tileStrings, tilesLength);
+		table.assign(nStates * nStates * nStates * nClasses, 0);
+		string tStr = "###";
+		for (int ul = 0; ul < nStates; ul++)
+			for (int u = 0; u < nStates; u++)
+				for (int l = 0; l < nStates; l++) {
+					tStr[0] = states[ul];
+					tStr[1] = states[u];
+					tStr[2] = states[l];
+					string ttStr = tiles.getPossibleEndings(tStr, 0);
+					for (int c = 0; c < nClasses; c++) {
+						int sign = -1;
+						for (int k = 0; k < ttStr.size(); k++) {
+							if (pi[ttStr[k]].find(static_cast<char>(representative[c])) != string::npos) sign = k;
+						}
+						if (sign >= 0)
+							table[((ul * nStates + u) * nStates + l) * nClasses + c] = states.find(ttStr[sign]) + 1;
+					}
+				}
+	}
 };
 
 #endif
\ No newline at end of file
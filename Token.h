@@ -51,25 +51,68 @@ enum TokenType {
 	ERROR
 };
 
+/**
+ * Tokens are small tagged values: the type plus up to two ints of payload
+ * (number, identifier, cell position or picture size). The lexer stores
+ * them contiguously and the parser refers to them by index.
+ */
 class Token {
 public:
-	Token(TokenType ptype) {
-		type = ptype;
+	Token(TokenType ptype = ERROR, int pfirst = 0, int psecond = 0)
+		: type(ptype), first(pfirst), second(psecond) { }
+
+	static Token number(int number) {
+		return Token(NUMBER, number);
+	}
+
+	static Token identifier(int identifier) {
+		return Token(IDENTIFIER, identifier);
+	}
+
+	static Token cell(int x, int y) {
+		return Token(CELL, x, y);
 	}
 
-	virtual ~Token() {}
+	static Token picture(int width, int height) {
+		return Token(PICTURE, width, height);
+	}
 
-	TokenType getType() {
+	TokenType getType() const {
 		return type;
 	}
 
-	virtual std::string print() {
+	int getNumber() const {
+		return first;
+	}
+
+	int getIdentity() const {
+		return first;
+	}
+
+	int getX() const {
+		return first;
+	}
+
+	int getY() const {
+		return second;
+	}
+
+	int getWidth() const {
+		return first;
+	}
+
+	int getHeight() const {
+		return second;
+	}
+
+	std::string print() const {
+		std::stringstream out;
 		switch(type) {
-			case NUMBER: return "<o ohh simple number>";
-			case IDENTIFIER: return "<o ohh simple identifier>";
-			case PICTURE: return "<o ohh simple picture>";
+			case NUMBER: out << "<Number:" << first << ">"; return out.str();
+			case IDENTIFIER: out << "<Identifier:" << first << ">"; return out.str();
+			case PICTURE: out << "<Picture:("<< first << "," << second << ")>"; return out.str();
 			case PICTURE_END: return "<PICTURE_END>";
-			case CELL: return "<o ohh simple cell>";
+			case CELL: out << "<Cell:("<< first << "," << second << ")>"; return out.str();
 			case QMARK: return "<?>";
 			case EQUALS: return "<=>";
 			case COMMA: return "<,>";
@@ -104,102 +147,7 @@ public:
 
 private:
 	TokenType type;
-};
-
-
-
-class NumberToken : public Token {
-public:
-	NumberToken(int number) : Token(NUMBER), number(number) {}
-
-	virtual ~NumberToken() {}
-
-	int getNumber() {
-		return number;
-	}
-	
-	std::string print() {
-		std::stringstream out;
-		out << "<Number:" << number << ">";
-		return out.str();
-	}
-
-private:
-	int number;
-};
-
-
-
-class IdentifierToken : public Token {
-public:
-	IdentifierToken(int identifier) : Token(IDENTIFIER), identifier(identifier) {}
-
-	virtual ~IdentifierToken() {}
-
-	int getIdentity() {
-		return identifier;
-	}
-
-	std::string print() {
-		std::stringstream out;
-		out << "<Identifier:" << identifier << ">";
-		return  out.str();
-	}
-
-private:
-	int identifier;
-};
-
-
-
-class CellToken : public Token {
-public:
-	CellToken(int x, int y):Token(CELL), x(x), y(y) {}
-
-	virtual ~CellToken() {}
-
-	int getX() {
-		return x;
-	}
-
-	int getY() {
-		return y;
-	}
-
-	std::string print() {
-		std::stringstream out;
-		out << "<Cell:("<< x << "," << y << ")>";
-		return out.str();
-	}
-
-private:
-	int x, y;
-};
-
-
-
-class PictureToken : public Token {
-public:
-	PictureToken(int width, int height) : Token(PICTURE), width(width), height(height) {}
-
-	virtual ~PictureToken() {}
-
-	int getWidth() {
-		return width;
-	}
-	
-	int getHeight() {
-		return height;
-	}
-
-	std::string print() {
-		std::stringstream out;
-		out << "<Picture:("<< width << "," << height << ")>";
-		return out.str();
-	}
-
-private:
-	int width, height;
+	int first, second;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,144 @@
+#ifndef _VALUE_SET_H_
+#define _VALUE_SET_H_
+
+#include <vector>
+#include <algorithm>
+#include <iterator>
+
+using namespace std;
+
+/**
+ * The values a set of the header stands for: numbers as a sorted list of
+ * disjoint, non adjacent intervals and identifiers as a sorted list of
+ * their numbers. Union, intersection and relative complement work on the
+ * intervals, so a range costs the same whatever its length.
+ */
+class ValueSet {
+public:
+	struct Interval {
+		int first, last; // both included
+	};
+
+	ValueSet() { }
+
+	void addNumber(int n) {
+		addRange(n, n);
+	}
+
+	void addRange(int first, int last) {
+		if (first > last) return;
+		Interval i = {first, last};
+		ValueSet other;
+		other.intervals.push_back(i);
+		unite(other);
+	}
+
+	void addIdentifier(int ident) {
+		vector<int>::iterator it = lower_bound(identifiers.begin(), identifiers.end(), ident);
+		if (it == identifiers.end() || *it != ident) identifiers.insert(it, ident);
+	}
+
+	void unite(const ValueSet & other) {
+		vector<Interval> result;
+		int i = 0, j = 0;
+		while (i < intervals.size() || j < other.intervals.size()) {
+			Interval next;
+			if (j >= other.intervals.size() || (i < intervals.size() && intervals[i].first <= other.intervals[j].first))
+				next = intervals[i++];
+			else next = other.intervals[j++];
+			// merge overlapping and adjacent intervals
+			if (!result.empty() && (long)next.first <= (long)result.back().last + 1)
+				result.back().last = max(result.back().last, next.last);
+			else result.push_back(next);
+		}
+		intervals.swap(result);
+
+		vector<int> ids;
+		set_union(identifiers.begin(), identifiers.end(), other.identifiers.begin(), other.identifiers.end(), back_inserter(ids));
+		identifiers.swap(ids);
+	}
+
+	void intersect(const ValueSet & other) {
+		vector<Interval> result;
+		int i = 0, j = 0;
+		while (i < intervals.size() && j < other.intervals.size()) {
+			Interval cut = {max(intervals[i].first, other.intervals[j].first), min(intervals[i].last, other.intervals[j].last)};
+			if (cut.first <= cut.last) result.push_back(cut);
+			// the interval ending first cannot overlap anything further
+			if (intervals[i].last < other.intervals[j].last) i++;
+			else j++;
+		}
+		intervals.swap(result);
+
+		vector<int> ids;
+		set_intersection(identifiers.begin(), identifiers.end(), other.identifiers.begin(), other.identifiers.end(), back_inserter(ids));
+		identifiers.swap(ids);
+	}
+
+	// removes all values of other
+	void subtract(const ValueSet & other) {
+		vector<Interval> result;
+		int j = 0;
+		for (int i = 0; i < intervals.size(); i++) {
+			Interval rest = intervals[i];
+			while (j < other.intervals.size() && other.intervals[j].last < rest.first) j++;
+			int k = j;
+			for (; k < other.intervals.size() && other.intervals[k].first <= rest.last; k++) {
+				if (other.intervals[k].first > rest.first) {
+					Interval before = {rest.first, other.intervals[k].first - 1};
+					result.push_back(before);
+				}
+				if (other.intervals[k].last >= rest.last) break;
+				rest.first = other.intervals[k].last + 1;
+			}
+			if (k == other.intervals.size() || other.intervals[k].first > rest.last) result.push_back(rest);
+		}
+		intervals.swap(result);
+
+		vector<int> ids;
+		set_difference(identifiers.begin(), identifiers.end(), other.identifiers.begin(), other.identifiers.end(), back_inserter(ids));
+		identifiers.swap(ids);
+	}
+
+	bool containsNumber(int n) const {
+		int low = 0, high = intervals.size();
+		while (low < high) {
+			int mid = (low + high) / 2;
+			if (intervals[mid].last < n) low = mid + 1;
+			else high = mid;
+		}
+		return low < intervals.size() && intervals[low].first <= n;
+	}
+
+	bool containsIdentifier(int ident) const {
+		return binary_search(identifiers.begin(), identifiers.end(), ident);
+	}
+
+	long numberCount() const {
+		long n = 0;
+		for (int i = 0; i < intervals.size(); i++) n += (long)intervals[i].last - intervals[i].first + 1;
+		return n;
+	}
+
+	long size() const {
+		return numberCount() + identifiers.size();
+	}
+
+	bool isEmpty() const {
+		return intervals.empty() && identifiers.empty();
+	}
+
+	const vector<Interval> & getIntervals() const {
+		return intervals;
+	}
+
+	const vector<int> & getIdentifiers() const {
+		return identifiers;
+	}
+
+private:
+	vector<Interval> intervals;
+	vector<int> identifiers;
+};
+
+#endif
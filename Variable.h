@@ -5,7 +5,7 @@
 #include <string>
 #include <vector>
 #include "Set.h"
-#include "counted_ptr.h"
+#include "arena_ptr.h"
 
 enum VariableType{
 	VAR_SET,
@@ -13,65 +13,57 @@ enum VariableType{
 	VAR_CONTENT
 };
 
-class Variable {
+class VariableSet {
 public:
-	Variable(VariableType type) : type(type) {}
-	
-	VariableType getType() {
-		return type;
-	}
+	VariableSet() : set(NULL) {	}
 
-	string print() {
-		switch (type) {
-		case VAR_SET:		return "var set";
-		case SET_CONTENT:	return "set content";
-		case VAR_CONTENT:	return "var set content";
-		default:			return "variable without type";
-		}
+	VariableSet(arena_ptr<Set> set) : set(set) {
+		if (set->getType() == SET_IDENTIFIER) set = arena_ptr<Set>(NULL);
 	}
 
-private:
-	VariableType type;
-};
-
-class VariableSet : public Variable {
-public:
-	VariableSet() : Variable(VAR_SET), set(NULL) {	}
-
-	VariableSet(counted_ptr<Set> set) : Variable(VAR_SET), set(set) {
-		if (set->getType() == SET_IDENTIFIER) set = counted_ptr<Set>(NULL);
-	}
-
-	counted_ptr<Set> getSet() {
+	arena_ptr<Set> getSet() {
 		return set;
 	}
 private:
-	counted_ptr<Set> set;
+	arena_ptr<Set> set;
 };
 
-class VariableContent : public Variable {
+// a local variable, defined by its position in the left picture of each block using it
+class VariableContent {
 public:
-	VariableContent() : Variable(VAR_CONTENT) {	}
+	VariableContent() {	}
 
 	struct Koord {
 		int x;
 		int y;
 	};
 
+	// block is the number of the block (getBlockIdent), the positions are indexed by it
 	void setKoord(int block, Koord koord) {
+		if (block >= koords.size()) {
+			Koord none = {0, 0};
+			koords.resize(block + 1, none);
+			defined.resize(block + 1, false);
+		}
 		koords[block] = koord;
+		defined[block] = true;
 	}
 
 	bool defInBlock(int block) {
-		return koords.count(block);
+		return block >= 0 && block < defined.size() && defined[block];
 	}
 
 	Koord getKoord(int block) {
+		if (!defInBlock(block)) {
+			Koord none = {0, 0};
+			return none;
+		}
 		return koords[block];
 	}
 
 private:
-	map<int, Koord> koords;
+	vector<Koord> koords;
+	vector<char> defined;
 };
 
 #endif
\ No newline at end of file
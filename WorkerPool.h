@@ -0,0 +1,30 @@
+#ifndef _WORKER_POOL_H_
+#define _WORKER_POOL_H_
+
+#include <vector>
+#include <thread>
+#include <atomic>
+
+using namespace std;
+
+/**
+ * Runs independent pieces of work on a few threads, each thread taking the
+ * next index until there is none left.
+ */
+class WorkerPool {
+public:
+	// calls work(0) ... work(n-1) on up to 'threads' threads
+	template <class F>
+	static void run(int n, int threads, F work) {
+		atomic<int> nextIndex(0);
+		vector<thread> pool;
+		for (int t = 0; t < threads && t < n; t++) {
+			pool.push_back(thread([&]() {
+				for (int i = nextIndex++; i < n; i = nextIndex++) work(i);
+			}));
+		}
+		for (int t = 0; t < pool.size(); t++) pool[t].join();
+	}
+};
+
+#endif
@@ -14,14 +14,14 @@
 #include "Lexer.h"
 #include "Set.h"
 #include "BasicData.h"
-#include "Variable.h"
+#include "SymbolTable.h"
 
 //#define _ZASIM_CODE_GEN_DEBUG
 
 #ifdef _ZASIM_CODE_GEN_DEBUG
-#define toOutStream outStream << "</span><span title=\"" << __LINE__ << "\" style=\"color: hsl(" << ((__LINE__ * 1567396739L) % 360) << ", 100%, 75%);\">"
+#define toOutStream (*out) << "</span><span title=\"" << __LINE__ << "\" style=\"color: hsl(" << ((__LINE__ * 1567396739L) % 360) << ", 100%, 75%);\">"
 #else
-#define toOutStream outStream
+#define toOutStream (*out)
 #endif
 
 using std::pair;
@@ -29,8 +29,9 @@ using std::set;
 
 class ZasimCodeGenerator {
 public:
-	ZasimCodeGenerator(StringTable & strTable, map<int, counted_ptr<Variable>> & varTable, string name)
-	: varTable(varTable), strTable(strTable), posSet(counted_ptr<Set>(new Set())) {
+	ZasimCodeGenerator(StringTable & strTable, SymbolTable & varTable, string name)
+	: varTable(varTable), strTable(strTable), python_mode(false), posSet(Set::empty()), out(&outStream), gather(false)
+	, instrument(false), profileName(name + ".profile") {
 		outStream.open(name + ".zac");
 #ifdef _ZASIM_CODE_GEN_DEBUG
 		outStream << "<head><style>span { border: 1px solid #111; }</style></head><body bgcolor=\"black\"><pre>";
@@ -42,14 +43,21 @@ public:
 		outStream.close();
 	}
 
-	bool generateCode(CellFile & _program, Picture<counted_ptr<vector<CellStatement>>> &_setLists) {
+	/**
+	 * blockOrder gives the order in which the blocks are tested in the
+	 * generated chain, empty means the order of the file.
+	 */
+	bool generateCode(CellFile & _program, Picture<counted_ptr<vector<CellStatement>>> &_setLists, vector<int> blockOrder = vector<int>()) {
 		setLists = &_setLists;
 		program = &_program;
+		order = blockOrder;
+		if (order.empty())
+			for (int i = 0; i < program->blocks.size(); i++) order.push_back(i);
 		cellX = program->head.getCell()->getWidth();
 		cellY = program->head.getCell()->getHeight();
 		posSet.setSize(cellX, cellY);
 
-		counted_ptr<Picture<counted_ptr<CellStatement>>> pic = program->head.getCell();
+		arena_ptr<Picture<arena_ptr<CellStatement>>> pic = program->head.getCell();
 		for (int i = 0; i < cellX; i++)
 			for (int j = 0; j < cellY; j++) {
 				if (pic->get(i,j)->getType() != EMPTY) {
@@ -60,6 +68,7 @@ public:
 		writeHead();
 		writeSymbols();
 		writeStringTable();
+		collectAccesses(*program);
 		python_mode = true;
 		writeFunction(*program);
 		python_mode = false;
@@ -74,8 +83,29 @@ public:
 		return error.str();
 	}
 
+	/**
+	 * The cpp_code counts how often each block fires and writes the
+	 * counts to name.profile when the simulation exits.
+	 */
+	void setInstrument(bool b) {
+		instrument = b;
+	}
+
+	// where the counts go, name.profile by default
+	void setProfileName(const string & name) {
+		profileName = name;
+	}
+
+	/**
+	 * Instances each block fires for according to the function analysis,
+	 * blocks that never fire are marked in the cpp_code.
+	 */
+	void setCoverage(const vector<unsigned long long> & matched) {
+		coverage = matched;
+	}
+
 private:
-	map<int, counted_ptr<Variable>> & varTable;
+	SymbolTable & varTable;
 	StringTable & strTable;
 	map<int, int> symbol_remap;
 	stringstream error;
@@ -85,10 +115,34 @@ private:
 	bool python_mode;
 
 	int cellX, cellY;
-	Picture<counted_ptr<Set>> posSet;
+	Picture<arena_ptr<Set>> posSet;
 	ofstream outStream;
+	ostream * out;
 
 	set<pair<int, int>> neighbour_cells;
+	// position of each neighbour in neighbour_cells, fixed by collectAccesses
+	map<pair<int, int>, int> neighbour_index;
+
+	/**
+	 * Every (neighbour, sub-cell) pair read by the rules other than through
+	 * nbbits, filled by collectAccesses before the step functions are
+	 * written. While gather is set getCell prints the local loaded in the
+	 * prologue of the cpp_code instead of the neighbourhood accessor.
+	 */
+	set<pair<pair<int, int>, pair<int, int>>> accessed_cells;
+	bool gather;
+
+	/**
+	 * Cells with the set {0,1} taking part in a lowered neighbour count,
+	 * these are packed into the bits of nbbits by writeGather. Those at an
+	 * offset of 64 or more do not fit and are moved to accessed_cells.
+	 */
+	set<pair<pair<int, int>, pair<int, int>>> packed_cells;
+
+	vector<int> order;
+	vector<unsigned long long> coverage;
+	bool instrument;
+	string profileName;
 
 	void writeHead() {
 		toOutStream << "%YAML 1.1" << endl;
@@ -122,7 +176,7 @@ private:
 	 */
 	void writeSymbols() {
 		toOutStream << "sets:" << endl;
-		counted_ptr<Picture<counted_ptr<CellStatement>>> pic = program->head.getCell();
+		arena_ptr<Picture<arena_ptr<CellStatement>>> pic = program->head.getCell();
 		for (int i = 0; i < cellX; i++)
 			for (int j = 0; j < cellY; j++) {
 				if (pic->get(i,j)->getType() != EMPTY) {
@@ -180,16 +234,16 @@ private:
 			toOutStream << "    x: " << x << endl;
 			toOutStream << "    y: " << y << endl;
 			toOutStream << "    name: ";
-			getCell(a, x, y, false);
+			getCell(a, x * cellX, y * cellY, false);
 			toOutStream << endl;
 		}
 		toOutStream << endl;
 	}
 
-	bool isIdentInSet(counted_ptr<Set> set) {
+	bool isIdentInSet(arena_ptr<Set> set) {
 		if (set->getType() == SET_IDENTIFIER) {
 			SetIdentifier* s1 = static_cast<SetIdentifier*>(set.get());
-			return isIdentInSet(static_cast<VariableSet*>(varTable[s1->getName()].get())->getSet());
+			return isIdentInSet(varTable.getSet(s1->getName()));
 		
 		} else if (set->getType() == SET_ENUM) {
 			return static_cast<SetList*>(set.get())->getIdentifiers().size();
@@ -220,35 +274,121 @@ private:
 	void writeFunction(CellFile & file) {
 		if (python_mode)
 			toOutStream << "python_code: >" << endl << "    ";
-		else
+		else {
 			toOutStream << "cpp_code: >" << endl << "    ";
-		if (!file.blocks.empty()) translateBlock(file.blocks[0]);
-		for (int i = 1; i < file.blocks.size(); i++) {
-			if (python_mode)
-				toOutStream << endl << "    el";
-			else
-				toOutStream << " else ";
-			translateBlock(file.blocks[i]);
+			if (instrument) writeInstrumentation(file);
+			writeGather();
+			gather = true;
+		}
+		for (int i = 0; i < order.size(); i++) {
+			if (i > 0) {
+				if (python_mode)
+					toOutStream << endl << "    el";
+				else
+					toOutStream << " else ";
+			}
+			if (!python_mode && order[i] < coverage.size() && coverage[order[i]] == 0)
+				toOutStream << "/* block " << order[i] << " never fires */ ";
+			translateBlock(file.blocks[order[i]], order[i]);
 		}
+		gather = false;
 		toOutStream << endl << endl << endl;
 	}
 
+	void writeInstrumentation(CellFile & file) {
+		toOutStream << "static unsigned long long block_hits[" << file.blocks.size() << "] = {0}; "
+			<< "static const int block_profile = std::atexit([] { "
+			<< "FILE * f = std::fopen(\"" << profileName << "\", \"w\"); if (!f) return; "
+			<< "for (int i = 0; i < " << file.blocks.size() << "; i++) std::fprintf(f, \"block %d %llu\\n\", i, block_hits[i]); "
+			<< "std::fclose(f); }); (void)block_profile;" << endl << "    ";
+	}
+
+	/**
+	 * Dry run over all blocks as for the cpp_code, to fill neighbour_cells,
+	 * accessed_cells and packed_cells, so the flat offsets and the locals
+	 * writeGather declares are known up front. Nothing the python_code
+	 * reads afterwards is needed by the cpp_code.
+	 */
+	void collectAccesses(CellFile & file) {
+		stringstream discard;
+		out = &discard;
+		python_mode = false;
+		for (int i = 0; i < file.blocks.size(); i++) translateBlock(file.blocks[i], i);
+		out = &outStream;
+		// cells read in a packed count only are not seen by getCell
+		for (auto cell : packed_cells) neighbour_cells.insert(cell.first);
+		int n = 0;
+		for (auto neighbour : neighbour_cells) neighbour_index[neighbour] = n++;
+		// beyond the 64 bits of nbbits translateBooleanSum reads the local itself
+		for (auto it = packed_cells.begin(); it != packed_cells.end(); ) {
+			if (flatOffset(it->first, it->second.first, it->second.second) < 64) ++it;
+			else {
+				accessed_cells.insert(*it);
+				it = packed_cells.erase(it);
+			}
+		}
+	}
+
+	/**
+	 * Offset of a sub-cell in the neighbourhood flattened in the order
+	 * of neighbour_cells, each neighbour spanning cellX * cellY slots.
+	 */
+	int flatOffset(pair<int, int> neighbour, int x0, int y0) {
+		map<pair<int, int>, int>::iterator it = neighbour_index.find(neighbour);
+		int n = (it == neighbour_index.end()) ? neighbour_index.size() : it->second;
+		return n * cellX * cellY + y0 * cellX + x0;
+	}
+
+	/**
+	 * Load every accessed or packed neighbour attribute into a local exactly
+	 * once, the conditions and results below only refer to these locals.
+	 */
+	void writeGather() {
+		Block a;
+		set<pair<pair<int, int>, pair<int, int>>> loaded(accessed_cells);
+		loaded.insert(packed_cells.begin(), packed_cells.end());
+		for (auto val : loaded) {
+			toOutStream << "const int nb" << flatOffset(val.first, val.second.first, val.second.second) << " = ";
+			getCell(a, val.first.first * cellX + val.second.first, val.first.second * cellY + val.second.second);
+			toOutStream << ";" << endl << "    ";
+		}
+
+		bool b = false;
+		for (auto val : packed_cells) {
+			int offset = flatOffset(val.first, val.second.first, val.second.second);
+			toOutStream << (b ? " | " : "const unsigned long long nbbits = ");
+			toOutStream << "((unsigned long long)nb" << offset << " << " << offset << ")";
+			b = true;
+		}
+		if (b) toOutStream << ";" << endl << "    ";
+	}
 
-	void translateBlock(Block & block) {
+	/**
+	 * Neighbour and sub-cell of the cell at (x, y) in the left picture of block.
+	 */
+	pair<pair<int, int>, pair<int, int>> locateCell(Block & block, int x, int y) {
+		int x0(x-block.getX()), y0(y-block.getY());
+		int rx = (x0 < 0) ? -((cellX - 1 - x0) / cellX) : x0 / cellX;
+		int ry = (y0 < 0) ? -((cellY - 1 - y0) / cellY) : y0 / cellY;
+		return std::make_pair(std::make_pair(rx, ry), std::make_pair(x0 - rx * cellX, y0 - ry * cellY));
+	}
+
+
+	void translateBlock(Block & block, int index) {
 		string AND_S = python_mode ? "and " : "&& ";
 		toOutStream << "if (";
-		counted_ptr<Picture<counted_ptr<CellStatement>>> pic = block.getLeft();
+		const SymmetryView & pic = block.getLeft();
 		bool b = false;
-		for (int i = 0; i < pic->getWidth(); i++) {
-			for (int j = 0; j < pic->getHeight(); j++) {
-				if (pic->get(i,j)->getType() != EMPTY && pic->get(i,j)->getType() != SET_ONLY) {
+		for (int i = 0; i < pic.getWidth(); i++) {
+			for (int j = 0; j < pic.getHeight(); j++) {
+				if (pic.get(i,j)->getType() != EMPTY && pic.get(i,j)->getType() != SET_ONLY) {
 					// if (no variable initialization) not that important
-					if (pic->get(i,j)->getType() != CELL_IDENTIFIER && pic->get(i,j)->getType() != IDENTIFIER_IN_SET) {
+					if (pic.get(i,j)->getType() != CELL_IDENTIFIER && pic.get(i,j)->getType() != IDENTIFIER_IN_SET) {
 						if (b) toOutStream << AND_S << endl << "          ";
 						b = true;
 						translateCondition(block, i, j);
-					} else if (varTable[pic->get(i,j)->getIdentNumber()]->getType() == VAR_CONTENT) {
-						VariableContent::Koord k = static_cast<VariableContent *>(varTable[pic->get(i,j)->getIdentNumber()].get())->getKoord(block.getBlockIdent());
+					} else if (varTable.is(pic.get(i,j)->getIdentNumber(), VAR_CONTENT)) {
+						VariableContent::Koord k = varTable.getContent(pic.get(i,j)->getIdentNumber()).getKoord(block.getBlockIdent());
 						if (k.x != i || k.y != j) {
 							if (b) toOutStream << endl << "          " << AND_S;
 							b = true;
@@ -263,11 +403,11 @@ private:
 			}
 		}
 
-		for (int i = 0; i < pic->getWidth(); i++) {
-			for (int j = 0; j < pic->getHeight(); j++) {
-				if (pic->get(i,j)->getType() == IDENTIFIER_IN_SET || 
-					pic->get(i,j)->getType() == TERM_IN_SET || 
-					pic->get(i,j)->getType() == SET_ONLY) {
+		for (int i = 0; i < pic.getWidth(); i++) {
+			for (int j = 0; j < pic.getHeight(); j++) {
+				if (pic.get(i,j)->getType() == IDENTIFIER_IN_SET || 
+					pic.get(i,j)->getType() == TERM_IN_SET || 
+					pic.get(i,j)->getType() == SET_ONLY) {
 					
 					if (b) toOutStream << AND_S << endl << "          ";
 					b = true;
@@ -276,7 +416,7 @@ private:
 					if (isIdentInSet(i-block.getX(), j-block.getY())) {
 						idents = true;
 					}
-					translateSet(block, pic->get(i,j)->getSet(), idents, i, j);
+					translateSet(block, pic.get(i,j)->getSet(), idents, i, j);
 				}
 			}
 		}
@@ -302,6 +442,9 @@ private:
 		else
 			toOutStream << ") {" << endl;
 
+		if (instrument && !python_mode)
+			toOutStream << "        block_hits[" << index << "]++;" << endl;
+
 		translateResult(block);
 
 		if (!python_mode)
@@ -309,16 +452,16 @@ private:
 	}
 
 	bool translateCondition(Block & block, int x, int y) {
-		counted_ptr<CellStatement> c = block.getLeft()->get(x,y);
+		arena_ptr<CellStatement> c = block.getLeft().get(x,y);
 
 		getCell(block, x, y);
 		toOutStream << " == ";
 		if (c->getType() == CELL_IDENTIFIER || c->getType() == IDENTIFIER_IN_SET) {
 		
-			if (varTable[c->getIdentNumber()]->getType() == SET_CONTENT) {
+			if (varTable.is(c->getIdentNumber(), SET_CONTENT)) {
 				toOutStream << '"' << strTable.getString(c->getIdentNumber()) << '"';
-			} else if (varTable[c->getIdentNumber()]->getType() == VAR_CONTENT) {
-				VariableContent::Koord koord = static_cast<VariableContent *>(varTable[c->getIdentNumber()].get())->getKoord(block.getBlockIdent());
+			} else if (varTable.is(c->getIdentNumber(), VAR_CONTENT)) {
+				VariableContent::Koord koord = varTable.getContent(c->getIdentNumber()).getKoord(block.getBlockIdent());
 				getCell(block, koord.x, koord.y);
 			}
 
@@ -342,7 +485,7 @@ private:
 
 	void translateResult(Block & block) {
 		string COMMENT = python_mode ? " # " : " // ";
-		counted_ptr<Picture<counted_ptr<CellStatement>>> pic = block.getRight();
+		arena_ptr<Picture<arena_ptr<CellStatement>>> pic = block.getRight();
 		for (int i = 0; i < pic->getWidth(); i++)
 			for (int j = 0; j < pic->getHeight(); j++) {
 				if (pic->get(i,j)->getType() != EMPTY) {
@@ -351,15 +494,15 @@ private:
 					case CELL_NUMBER:
 						toOutStream << pic->get(i,j)->getIdentNumber();break;
 					case CELL_IDENTIFIER:
-						if (varTable[pic->get(i,j)->getIdentNumber()]->getType() == SET_CONTENT) {
+						if (varTable.is(pic->get(i,j)->getIdentNumber(), SET_CONTENT)) {
 							toOutStream << symbol_remap[pic->get(i,j)->getIdentNumber()];
 							toOutStream << COMMENT << '"' << strTable.getString(pic->get(i,j)->getIdentNumber()) << '"';
 							if (!python_mode)
 								toOutStream << ';';
 							toOutStream << endl;
-						} else  if (varTable[pic->get(i,j)->getIdentNumber()]->getType() == VAR_CONTENT) {
+						} else  if (varTable.is(pic->get(i,j)->getIdentNumber(), VAR_CONTENT)) {
 							// TODO when does this do something? do we need to translate it with the symbol_remap??
-							VariableContent::Koord koord = static_cast<VariableContent *>(varTable[pic->get(i,j)->getIdentNumber()].get())->getKoord(block.getBlockIdent());
+							VariableContent::Koord koord = varTable.getContent(pic->get(i,j)->getIdentNumber()).getKoord(block.getBlockIdent());
 							getCell(block, koord.x, koord.y);
 						}
 						break;
@@ -382,6 +525,11 @@ private:
 	}
 	
 	void getCell(Block & block, int x, int y, bool output_attr = true) {
+		if (gather && output_attr) {
+			pair<pair<int, int>, pair<int, int>> cell = locateCell(block, x, y);
+			toOutStream << "nb" << flatOffset(cell.first, cell.second.first, cell.second.second);
+			return;
+		}
 		int x0(x-block.getX()), y0(y-block.getY());
 		int rx(0), ry(0);
 		bool put_underscore(false);
@@ -418,16 +566,19 @@ private:
 		while(y0 < 0) {
 			toOutStream << US << "u";
 			y0 += cellY;
+			ry--;
 		}
 		while(y0 >= cellY) {
 			toOutStream << US << "d";
 			y0 -= cellY;
+			ry++;
 		}
 
 		neighbour_cells.insert(std::make_pair(rx, ry));
 		if (output_attr)
 		{
 			toOutStream << US << attr(x0, y0);
+			accessed_cells.insert(std::make_pair(std::make_pair(rx, ry), std::make_pair(x0, y0)));
 		}
 	}
 
@@ -445,7 +596,7 @@ private:
 			toOutStream << "  }" << endl;
 	}
 
-	void translateSet(Block & block, counted_ptr<Set> set, bool idents, int x, int y) {
+	void translateSet(Block & block, arena_ptr<Set> set, bool idents, int x, int y) {
 
 		string OR_S = python_mode ? " or " : " || ";
 		string AND_S = python_mode ? "and " : "&& ";
@@ -453,7 +604,7 @@ private:
 		string COMMENT = python_mode ? "#" : "//";
 
 		switch(set->getType()) {
-		case SET_IDENTIFIER:	translateSet(block, static_cast<VariableSet*>(varTable[static_cast<SetIdentifier*>(set.get())->getName()].get())->getSet(), idents, x, y); break;
+		case SET_IDENTIFIER:	translateSet(block, varTable.getSet(static_cast<SetIdentifier*>(set.get())->getName()), idents, x, y); break;
 		case SET_ENUM:		{
 								SetList * setL = static_cast<SetList *>(set.get());
 									
@@ -471,14 +622,14 @@ private:
 										else b = true;
 										getCell(block,x,y);
 										toOutStream << " == ";
-										if (varTable[setL->getIdentifiers()[j]]->getType() == SET_CONTENT) {
+										if (varTable.is(setL->getIdentifiers()[j], SET_CONTENT)) {
 
 											toOutStream << (symbol_remap[setL->getIdentifiers()[j]]);
 											toOutStream << ' ' << COMMENT << " '" << strTable.getString(setL->getIdentifiers()[j]) << "'" << endl;
 											toOutStream << "            ";
 
-										} else if (varTable[setL->getIdentifiers()[j]]->getType() == VAR_CONTENT) {
-											VariableContent::Koord koord = static_cast<VariableContent *>(varTable[setL->getIdentifiers()[j]].get())->getKoord(block.getBlockIdent());
+										} else if (varTable.is(setL->getIdentifiers()[j], VAR_CONTENT)) {
+											VariableContent::Koord koord = varTable.getContent(setL->getIdentifiers()[j]).getKoord(block.getBlockIdent());
 											getCell(block, koord.x, koord.y);
 										}
 									}
@@ -494,8 +645,8 @@ private:
 										else b = true;
 										getCell(block,x,y);
 										toOutStream << " == ";
-										if (varTable[setL->getIdentifiers()[j]]->getType() == VAR_CONTENT) {
-											VariableContent::Koord koord = static_cast<VariableContent *>(varTable[setL->getIdentifiers()[j]].get())->getKoord(block.getBlockIdent());
+										if (varTable.is(setL->getIdentifiers()[j], VAR_CONTENT)) {
+											VariableContent::Koord koord = varTable.getContent(setL->getIdentifiers()[j]).getKoord(block.getBlockIdent());
 											getCell(block, koord.x, koord.y);
 										}
 									}
@@ -527,20 +678,19 @@ private:
 		}
 	}
 
-	void translateTerm(counted_ptr<Term> t, Block & b) {
+	void translateTerm(arena_ptr<Term> t, Block & b) {
 		switch(t->getType()) {
 		case T_NUMBER:		toOutStream << static_cast<TermIdentNumber*>(t.get())->getIdentName();
 							break;
 		case T_IDENTIFIER:	{
 								// can only pass semantics test if this Identifier is a locally initialized VariableContent
-								VariableContent::Koord k = static_cast<VariableContent*>(
-									varTable[static_cast<TermIdentNumber*>(t.get())->getIdentName()].get())
-									->getKoord(b.getBlockIdent());
+								VariableContent::Koord k = varTable.getContent(static_cast<TermIdentNumber*>(t.get())->getIdentName()).getKoord(b.getBlockIdent());
 								getCell(b, k.x, k.y);
 								break;
 							}
 		case T_STATEMENT:	{
 								TermStatement* ts = static_cast<TermStatement*>(t.get());
+								if (!python_mode && ts->getOp() == OP_PLUS && translateBooleanSum(t, b)) break;
 								toOutStream << "(";
 								translateTerm(ts->getLeft(), b);
 								switch(ts->getOp()) {
@@ -558,6 +708,59 @@ private:
 		}
 	}
 
+	void flattenSum(arena_ptr<Term> t, vector<arena_ptr<Term>> & addends) {
+		if (t->getType() == T_STATEMENT && static_cast<TermStatement*>(t.get())->getOp() == OP_PLUS) {
+			flattenSum(static_cast<TermStatement*>(t.get())->getLeft(), addends);
+			flattenSum(static_cast<TermStatement*>(t.get())->getRight(), addends);
+		} else addends.push_back(t);
+	}
+
+	bool isBooleanCell(arena_ptr<Term> t, Block & b, pair<pair<int, int>, pair<int, int>> & cell) {
+		if (t->getType() != T_IDENTIFIER) return false;
+		VariableContent::Koord k = varTable.getContent(static_cast<TermIdentNumber*>(t.get())->getIdentName()).getKoord(b.getBlockIdent());
+		cell = locateCell(b, k.x, k.y);
+		vector<CellStatement> & values = *setLists->get(cell.second.first, cell.second.second);
+		return values.size() == 2
+			&& values[0].getType() == CELL_NUMBER && values[0].getIdentNumber() == 0
+			&& values[1].getType() == CELL_NUMBER && values[1].getIdentNumber() == 1;
+	}
+
+	/**
+	 * Sums over at least two distinct cells with the set {0,1} (neighbour
+	 * counts of outer totalistic rules) become one popcount over the
+	 * packed bits, the other addends are added as usual.
+	 */
+	bool translateBooleanSum(arena_ptr<Term> t, Block & b) {
+		vector<arena_ptr<Term>> addends, rest;
+		set<pair<pair<int, int>, pair<int, int>>> cells;
+		unsigned long long mask = 0;
+		flattenSum(t, addends);
+		for (int i = 0; i < addends.size(); i++) {
+			pair<pair<int, int>, pair<int, int>> cell;
+			if (isBooleanCell(addends[i], b, cell) && !cells.count(cell)) {
+				if (gather) {
+					int offset = flatOffset(cell.first, cell.second.first, cell.second.second);
+					if (offset >= 64) {
+						rest.push_back(addends[i]);
+						continue;
+					}
+					mask |= 1ull << offset;
+				}
+				cells.insert(cell);
+			} else rest.push_back(addends[i]);
+		}
+		if (cells.size() < 2) return false;
+
+		packed_cells.insert(cells.begin(), cells.end());
+		toOutStream << "(__builtin_popcountll(nbbits & 0x" << std::hex << mask << std::dec << "ull)";
+		for (int i = 0; i < rest.size(); i++) {
+			toOutStream << " + ";
+			translateTerm(rest[i], b);
+		}
+		toOutStream << ")";
+		return true;
+	}
+
 
 };
 
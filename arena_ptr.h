@@ -0,0 +1,31 @@
+/*
+ * arena_ptr - handle to an object owned by an Arena.
+ *
+ * It does not own or count anything, copying it copies a pointer. The
+ * object lives as long as the arena it was made in.
+ */
+
+#ifndef ARENA_PTR_H
+#define ARENA_PTR_H
+
+#include <cstddef>
+
+template <class X> class arena_ptr
+{
+public:
+    typedef X element_type;
+
+    explicit arena_ptr(X* p = NULL) : ptr(p) {}
+
+    // handles to derived nodes convert to handles to their base
+    template <class Y> arena_ptr(const arena_ptr<Y>& r) : ptr(r.get()) {}
+
+    X& operator*()  const {return *ptr;}
+    X* operator->() const {return ptr;}
+    X* get()        const {return ptr;}
+
+private:
+    X* ptr;
+};
+
+#endif // ARENA_PTR_H
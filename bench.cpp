@@ -0,0 +1,268 @@
+/*
+ * Benchmark of the compiler phases.
+ *
+ * Every file in examples/ and a set of generated rules scaled in one
+ * dimension each (number of blocks, sub-cells of the head, width of the
+ * neighbourhood, size of the set) is compiled --reps times. For each phase
+ * the median, 10th and 90th percentile of the wall time are written as tab
+ * separated lines
+ *
+ *     case  metric  unit  median  p10  p90
+ *
+ * to stdout and to --out. The function analysis tries the rule on every
+ * possible neighbourhood, its instances per second are what this tree has
+ * of a stepping kernel; the generated code runs inside zasim and is not
+ * measured here. With --baseline an earlier output is compared against and
+ * the exit status is 1 if a median got worse by more than --tolerance.
+ */
+
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "Compiler.h"
+
+using namespace std;
+
+struct Measurement {
+    string name, metric, unit;
+    double median, p10, p90;
+};
+
+// nearest rank, values sorted
+double percentile(const vector<double> & values, double p) {
+    int rank = (int)ceil(p / 100 * values.size());
+    if (rank < 1) rank = 1;
+    return values[rank - 1];
+}
+
+Measurement measure(const string & name, const string & metric, const string & unit, vector<double> values) {
+    sort(values.begin(), values.end());
+    Measurement m;
+    m.name = name; m.metric = metric; m.unit = unit;
+    m.median = percentile(values, 50);
+    m.p10 = percentile(values, 10);
+    m.p90 = percentile(values, 90);
+    return m;
+}
+
+/**
+ * Text of a picture, cells given row by row; a column is as wide as its
+ * widest text.
+ */
+string picture(const vector<vector<string> > & rows) {
+    vector<int> widths(rows[0].size(), 1);
+    for (int y = 0; y < rows.size(); y++)
+        for (int x = 0; x < rows[y].size(); x++) widths[x] = max(widths[x], (int)rows[y][x].size());
+    stringstream border;
+    border << "+";
+    for (int x = 0; x < widths.size(); x++) border << string(widths[x], '-') << "+";
+    stringstream out;
+    out << border.str() << endl;
+    for (int y = 0; y < rows.size(); y++) {
+        out << "|";
+        for (int x = 0; x < rows[y].size(); x++) out << rows[y][x] << string(widths[x] - rows[y][x].size(), ' ') << "|";
+        out << endl << border.str() << endl;
+    }
+    return out.str();
+}
+
+string number(int n) {
+    stringstream str;
+    str << n;
+    return str.str();
+}
+
+string block(const vector<vector<string> > & left, const vector<vector<string> > & right) {
+    return picture(left) + "=>\n" + picture(right) + "___________________________________\n";
+}
+
+string head(int rows, int values) {
+    vector<vector<string> > cells(rows, vector<string>(1, "in S"));
+    return picture(cells) + "S = {0,.., " + number(values - 1) + "}\n___________________________________\n";
+}
+
+// one block per pattern of a 3 cell neighbourhood over {0, 1, 2, 3}
+string scaleBlocks(int blocks) {
+    string text = head(1, 4);
+    for (int p = 0; p < blocks; p++) {
+        int a = p / 16 % 4, b = p / 4 % 4, c = p % 4;
+        vector<vector<string> > left(1), right(1);
+        left[0].push_back(number(a)); left[0].push_back("$ " + number(b)); left[0].push_back(number(c));
+        right[0].push_back(number((a + b + c) % 4));
+        text += block(left, right);
+    }
+    vector<vector<string> > left(1, vector<string>(1, "$ ")), right(1, vector<string>(1, "0"));
+    return text + picture(left) + "=>\n" + picture(right) + "else\n___________________________________\n";
+}
+
+// a head of 'rows' sub-cells over {0, 1}, rotated by one row per step
+string scaleHead(int rows) {
+    string text = head(rows, 2);
+    vector<vector<string> > left(rows, vector<string>(1)), right(rows, vector<string>(1));
+    for (int y = 0; y < rows; y++) {
+        left[y][0] = ((y == 0) ? "$ a" : "a") + number(y);
+        right[y][0] = "a" + number((y + 1) % rows);
+    }
+    return text + block(left, right);
+}
+
+// the sum of 'width' cells over {0, 1} modulo 2
+string scaleWidth(int width) {
+    string text = head(1, 2);
+    vector<vector<string> > left(1), right(1, vector<string>(1));
+    string sum;
+    for (int x = 0; x < width; x++) {
+        left[0].push_back(((x == width / 2) ? "$ x" : "x") + number(x));
+        sum += ((x == 0) ? "(x" : "+x") + number(x);
+    }
+    right[0][0] = sum + ")%2";
+    return text + block(left, right);
+}
+
+// the sum of a 3 cell neighbourhood over a set of 'values' numbers
+string scaleSet(int values) {
+    string text = head(1, values);
+    vector<vector<string> > left(1), right(1, vector<string>(1, "(a+b+c)%" + number(values)));
+    left[0].push_back("a"); left[0].push_back("$ b"); left[0].push_back("c");
+    return text + block(left, right);
+}
+
+void benchmark(const string & name, const string & file, int reps, vector<Measurement> & results) {
+    CompileOptions options;
+    Compiler compiler(options);
+    map<string, vector<double> > times;
+    vector<string> phases;
+    vector<double> total, throughput;
+    bool ok = true;
+    for (int r = 0; r < reps; r++) {
+        CompileResult result = compiler.compile(file);
+        ok = ok && result.succeeded();
+        const vector<PhaseRecord> & records = result.stats.getPhases();
+        double sum = 0;
+        for (int i = 0; i < records.size(); i++) {
+            if (r == 0) phases.push_back(records[i].name);
+            times[records[i].name].push_back(records[i].wall);
+            sum += records[i].wall;
+            if (records[i].name != "function analysis" || records[i].wall <= 0) continue;
+            const vector<pair<string, unsigned long long> > & counters = result.stats.getCounters();
+            for (int j = 0; j < counters.size(); j++)
+                if (counters[j].first == "instances") throughput.push_back(counters[j].second / (records[i].wall / 1000));
+        }
+        total.push_back(sum);
+    }
+    if (!ok) cerr << "warning: " << file << " does not compile, only the phases it reaches are measured" << endl;
+    for (int i = 0; i < phases.size(); i++)
+        if (times[phases[i]].size() == reps) results.push_back(measure(name, phases[i], "ms", times[phases[i]]));
+    results.push_back(measure(name, "total", "ms", total));
+    if (throughput.size() == reps) results.push_back(measure(name, "instances", "1/s", throughput));
+}
+
+void write(ostream & out, const Measurement & m) {
+    out << m.name << "\t" << m.metric << "\t" << m.unit << "\t" << fixed << setprecision(4)
+        << m.median << "\t" << m.p10 << "\t" << m.p90 << endl;
+}
+
+string writeFile(const string & dir, const string & name, const string & text) {
+    string path = dir + "/" + name + ".txt";
+    ofstream out(path);
+    out << text;
+    return path;
+}
+
+int main(int argc, char** argv) {
+    int reps = 9;
+    string examples = "examples", work = "bench_work", outName = "bench_results.tsv", baseline;
+    double tolerance = 0.2;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--reps" && i + 1 < argc) reps = max(1, atoi(argv[++i]));
+        else if (arg == "--examples" && i + 1 < argc) examples = argv[++i];
+        else if (arg == "--out" && i + 1 < argc) outName = argv[++i];
+        else if (arg == "--baseline" && i + 1 < argc) baseline = argv[++i];
+        else if (arg == "--tolerance" && i + 1 < argc) tolerance = atof(argv[++i]);
+    }
+    // the outputs of the compiler are written next to its input, so everything is compiled from a copy
+    mkdir(work.c_str(), 0755);
+
+    vector<pair<string, string> > cases; // name, file
+    vector<string> exampleFiles;
+    if (DIR * dir = opendir(examples.c_str())) {
+        for (dirent * entry = readdir(dir); entry; entry = readdir(dir)) {
+            string file = entry->d_name;
+            if (file.size() > 4 && file.compare(file.size() - 4, 4, ".txt") == 0) exampleFiles.push_back(file);
+        }
+        closedir(dir);
+    }
+    sort(exampleFiles.begin(), exampleFiles.end());
+    for (int i = 0; i < exampleFiles.size(); i++) {
+        ifstream in(examples + "/" + exampleFiles[i]);
+        stringstream text;
+        text << in.rdbuf();
+        string name = exampleFiles[i].substr(0, exampleFiles[i].size() - 4);
+        replace(name.begin(), name.end(), ' ', '_');
+        cases.push_back(make_pair("examples/" + name, writeFile(work, name, text.str())));
+    }
+    int blocks[] = {4, 16, 64};
+    for (int i = 0; i < 3; i++)
+        cases.push_back(make_pair("blocks/" + number(blocks[i]), writeFile(work, "blocks" + number(blocks[i]), scaleBlocks(blocks[i]))));
+    int rows[] = {2, 4, 8};
+    for (int i = 0; i < 3; i++)
+        cases.push_back(make_pair("head/" + number(rows[i]), writeFile(work, "head" + number(rows[i]), scaleHead(rows[i]))));
+    int widths[] = {3, 5, 7, 9};
+    for (int i = 0; i < 4; i++)
+        cases.push_back(make_pair("width/" + number(widths[i]), writeFile(work, "width" + number(widths[i]), scaleWidth(widths[i]))));
+    int values[] = {4, 8, 16, 32};
+    for (int i = 0; i < 4; i++)
+        cases.push_back(make_pair("set/" + number(values[i]), writeFile(work, "set" + number(values[i]), scaleSet(values[i]))));
+
+    vector<Measurement> results;
+    for (int i = 0; i < cases.size(); i++) benchmark(cases[i].first, cases[i].second, reps, results);
+
+    ofstream out(outName);
+    out << "# case\tmetric\tunit\tmedian\tp10\tp90\t(" << reps << " repetitions)" << endl;
+    cout << "# case\tmetric\tunit\tmedian\tp10\tp90\t(" << reps << " repetitions)" << endl;
+    for (int i = 0; i < results.size(); i++) {
+        write(out, results[i]);
+        write(cout, results[i]);
+    }
+    if (baseline.empty()) return 0;
+
+    // compare the medians, times have to stay below and rates above the baseline
+    ifstream base(baseline);
+    if (!base) {
+        cerr << "cannot read " << baseline << endl;
+        return 1;
+    }
+    map<string, double> before;
+    string line;
+    while (getline(base, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        stringstream fields(line);
+        string name, metric, unit;
+        double median;
+        if (getline(fields, name, '\t') && getline(fields, metric, '\t') && getline(fields, unit, '\t') && fields >> median)
+            before[name + "\t" + metric] = median;
+    }
+    int regressions = 0;
+    cout << endl << "# compared with " << baseline << ", tolerance " << tolerance * 100 << "%" << endl;
+    for (int i = 0; i < results.size(); i++) {
+        map<string, double>::iterator it = before.find(results[i].name + "\t" + results[i].metric);
+        if (it == before.end() || it->second <= 0) continue;
+        double ratio = results[i].median / it->second;
+        bool worse = (results[i].unit == "ms") ? (ratio > 1 + tolerance && results[i].median - it->second > 0.05)
+                                              : (ratio < 1 / (1 + tolerance));
+        if (worse) regressions++;
+        cout << results[i].name << "\t" << results[i].metric << "\t" << fixed << setprecision(3) << ratio
+             << (worse ? "\tREGRESSION" : "") << endl;
+    }
+    cout << "# " << regressions << " regressions" << endl;
+    return regressions ? 1 : 0;
+}
@@ -0,0 +1,81 @@
+/*
+ * Client of the compile server (main --serve socket). Takes the arguments
+ * of main for one file, sends the file to the server and writes what comes
+ * back where main would have written it.
+ *
+ *     client [--socket path] [--instrument] [--stats] [--profile file] file
+ *     client [--socket path] --shutdown
+ */
+
+#include <cstdlib>
+#include <climits>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "CompileProtocol.h"
+
+using namespace std;
+
+// as Compiler::baseName, without pulling in the compiler
+string baseName(const string & name) {
+    size_t slash = name.find_last_of('/');
+    size_t dot = name.find_first_of('.', (slash == string::npos) ? 0 : slash + 1);
+    return name.substr(0, dot);
+}
+
+int main(int argc, char** argv) {
+    string name = "example.txt", socketPath = DEFAULT_SOCKET;
+    Message request;
+    bool shutdown = false;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) socketPath = argv[++i];
+        else if (arg == "--instrument" || arg == "--stats") request.push_back(make_pair(arg.substr(2), ""));
+        else if (arg == "--profile" && i + 1 < argc) {
+            // the server has a working directory of its own
+            char path[PATH_MAX];
+            request.push_back(make_pair("profile", realpath(argv[i + 1], path) ? string(path) : string(argv[i + 1])));
+            i++;
+        }
+        else if (arg == "--shutdown") shutdown = true;
+        else name = arg;
+    }
+    if (shutdown) request.push_back(make_pair("shutdown", ""));
+    else {
+        // a file that cannot be read compiles as an empty one, as in main
+        ifstream in(name, ios::in | ios::binary);
+        stringstream text;
+        if (in) text << in.rdbuf();
+        request.push_back(make_pair("name", name));
+        request.push_back(make_pair("text", text.str()));
+    }
+
+    int fd = CompileProtocol::connectTo(socketPath);
+    if (fd < 0) {
+        cerr << "no compile server at " << socketPath << endl;
+        return 2;
+    }
+    Message response;
+    string refused;
+    bool answered = CompileProtocol::send(fd, request) && CompileProtocol::receive(fd, response, &refused);
+    close(fd);
+    if (!refused.empty()) {
+        cerr << "the response of the compile server at " << socketPath << " was refused, it had " << refused << endl;
+        return 2;
+    }
+    if (!answered) {
+        cerr << "the compile server at " << socketPath << " did not answer" << endl;
+        return 2;
+    }
+    if (shutdown) return 0;
+
+    string name0 = baseName(name);
+    for (int i = 0; i < response.size(); i++) {
+        const string & field = response[i].first;
+        if (field == "status") continue;
+        ofstream out(name0 + ((field == "log") ? "_log.txt" : field), ios::out | ios::binary);
+        out << response[i].second;
+    }
+    return 0;
+}
@@ -0,0 +1,85 @@
+#!/bin/sh
+# Compiles small rules with main and checks the outcome of each, for cases
+# that the examples do not cover.
+#
+#     compile_check.sh [main]
+#
+# Prints one line per case and exits with 1 if any of them fails.
+
+main=$(cd "$(dirname "${1:-./main}")" && pwd)/$(basename "${1:-./main}")
+dir=$(mktemp -d /tmp/compile_check.XXXXXX) || exit 1
+trap 'rm -rf "$dir"' EXIT
+cd "$dir" || exit 1
+failed=0
+
+# check <case> <command...>: the case passes if the command succeeds
+check() {
+    name=$1
+    shift
+    if "$@"; then
+        echo "ok      $name"
+    else
+        echo "FAILED  $name"
+        failed=1
+    fi
+}
+
+cat > clean.txt <<'EOF'
++----+
+|in S|   S = {0,1}
++----+
+___________________________________
++-+---+-+        +-+
+|0|$ 0|1|   =>   |1|
++-+---+-+        +-+
+___________________________________
++---+            +-+
+|$  |       =>   |0|
++---+            +-+
+EOF
+
+# the lexer skips spaces at the end of a line but fails on a tab
+awk 'NR == 2 { $0 = $0 "   " } 1' clean.txt > spaces.txt
+awk 'NR == 2 { $0 = $0 "\t" } 1' clean.txt > tab.txt
+"$main" --cache cache clean.txt
+"$main" --cache cache spaces.txt
+"$main" --cache cache tab.txt
+check "trailing spaces hit the cache" grep -q "^cache: *hit" spaces_log.txt
+check "a trailing tab misses the cache" sh -c '! grep -q "^cache: *hit" tab_log.txt && grep -q "^parsing: *failure" tab_log.txt'
+
+# mirrored, the block shows the same cells in a view padded to whole cells
+cat > mirror.txt <<'EOF'
++----+
+|in S|   S = {0,1}
++----+
+|in S|
++----+
+___________________________________
++---+            +-+
+| 0 |            |1|
++---+            +-+
+|   |       =>   |1|
++---+            +-+
+|$ 1|
++---+
+|  1|
++---+
+| 0 |
++---+
+mirrorY
+___________________________________
++---+            +-+
+|$  |       =>   |0|
++---+            +-+
+|   |            |0|
++---+            +-+
+EOF
+"$main" mirror.txt
+check "a self-symmetric mirror is a duplicate" grep -q "^duplicate blocks: *1 removed" mirror_log.txt
+
+# dots in front of a picture, the lexer must still find the picture
+awk 'NR == 5 { $0 = ".. " $0 } NR == 6 || NR == 7 { $0 = "   " $0 } 1' clean.txt > dots.txt
+"$main" dots.txt
+check "dots before a picture are one unexpected token" sh -c 'grep -q "unexpected token inside a block <\.\.\.>" dots_log.txt && ! grep -q "picture missing" dots_log.txt'
+
+exit $failed
@@ -9,6 +9,7 @@
 #include <string>
 #include <vector>
 #include "counted_ptr.h"
+#include "Arena.h"
 #include "Lexer.h"
 #include "Picture.h"
 #include "TilingAutomaton.h"
@@ -17,12 +18,22 @@
 #include "Set.h"
 #include "Term.h"
 #include "StringTable.h"
+#include "SymbolTable.h"
 #include "Parser.h"
+#include "FrontEnd.h"
 #include "BasicData.h"
 #include "SemanticsAnalyser.h"
 //#include "CodeGenerator.h"
 #include "ZasimCodeGenerator.h"
 #include "FunctionAnalyser.h"
+#include "BlockProfile.h"
+#include "WorkerPool.h"
+#include "Compiler.h"
+#include "CompileServer.h"
+#include <climits>
+#include <algorithm>
+#include <dirent.h>
+#include <sys/stat.h>
 /*#include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -30,86 +41,116 @@
 
 using namespace std;
 
-int main(int argc, char** argv) {
-    string name = "example.txt";
-    if (argc > 1) name = argv[1];
-    string name0 = name.substr(0,name.find_first_of('.'));
-
-    StringTable strTable;
-    map<int, counted_ptr<Variable> > varTable;
-
-    Lexer lexer(name, strTable);
-    Parser parser(lexer, strTable);
-    SemanticsAnalyser analyser(varTable);
-    FunctionAnalyser fana(strTable, varTable, name0);
-    ZasimCodeGenerator cgen(strTable, varTable, name0);
-
-    CellFile file;
-    bool b(false),c(false),d(false),e(false);
-    b = parser.parseFile(file);
-    if (b) c = analyser.analyseProgram(file);
-    if (c) d = fana.analyseFunction(file);
-    if (d) e = cgen.generateCode(file, fana.setLists);
+// the rule files named in a list file, one per line, or the .txt files of a directory
+bool batchFiles(const string & source, vector<string> & files) {
+    struct stat info;
+    if (stat(source.c_str(), &info) != 0) return false;
+    if (S_ISDIR(info.st_mode)) {
+        DIR * dir = opendir(source.c_str());
+        if (!dir) return false;
+        for (dirent * entry = readdir(dir); entry; entry = readdir(dir)) {
+            string file = entry->d_name;
+            // skip what earlier runs wrote
+            if (file.size() < 4 || file.compare(file.size() - 4, 4, ".txt") != 0) continue;
+            if (file.size() >= 13 && file.compare(file.size() - 13, 13, "_analysis.txt") == 0) continue;
+            if (file.size() >= 8 && file.compare(file.size() - 8, 8, "_log.txt") == 0) continue;
+            files.push_back(source + "/" + file);
+        }
+        closedir(dir);
+        sort(files.begin(), files.end());
+    } else {
+        ifstream list(source);
+        string line;
+        while (getline(list, line)) {
+            if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+            if (!line.empty()) files.push_back(line);
+        }
+    }
+    return true;
+}
 
+// the phases of all results as a Chrome trace event file (chrome://tracing, Perfetto)
+void writeTrace(const string & traceName, const vector<CompileResult> & results) {
+    ofstream trace(traceName);
+    double base = 0;
+    for (int i = 0; i < results.size(); i++)
+        if (i == 0 || results[i].stats.getOrigin() < base) base = results[i].stats.getOrigin();
+    bool first = true;
+    trace << "{\"traceEvents\":[" << endl;
+    for (int i = 0; i < results.size(); i++)
+        results[i].stats.writeTraceEvents(trace, results[i].name, i, results[i].stats.getOrigin() - base, first);
+    trace << endl << "]}" << endl;
+}
 
-    ofstream outStream;
-    outStream.open(name0 + "_log.txt");
-    /*
-    outStream << "remaining tokens:    ";
-    counted_ptr<Token> token = lexer.next();
-    while (token->getType() != EOFILE) {
-        outStream << token->print();
-        token = lexer.next();
+int main(int argc, char** argv) {
+    string name = "example.txt";
+    string batch, reportName = "batch_report.txt", traceName, socketPath;
+    int jobs = thread::hardware_concurrency();
+    CompileOptions options;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--instrument") options.instrument = true;
+        else if (arg == "--stream") options.streaming = true;
+        else if (arg == "--stats") options.stats = true;
+        else if (arg == "--trace" && i + 1 < argc) traceName = argv[++i];
+        else if (arg == "--profile" && i + 1 < argc) options.profileName = argv[++i];
+        else if (arg == "--cache" && i + 1 < argc) options.cacheDir = argv[++i];
+        else if (arg == "--batch" && i + 1 < argc) batch = argv[++i];
+        else if (arg == "--jobs" && i + 1 < argc) jobs = atoi(argv[++i]);
+        else if (arg == "--report" && i + 1 < argc) reportName = argv[++i];
+        else if (arg == "--serve") socketPath = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : DEFAULT_SOCKET;
+        else name = arg;
     }
-    outStream << token->print() << endl << endl;
-    */
-    outStream << "parsing file " << name << endl << endl;
 
-    outStream << "parsing:             " << (b? "successful": "failure") << endl;
-    outStream << "semantics analysis:  " << (c? "successful": "failure") << endl;
-    outStream << "function analysis:   " << (d? "successful": "failure") << endl;
-    outStream << "code generator:      " << (e? "successful": "failure") << endl << endl;
-
-    outStream << "parse error:         " << parser.getError()   << endl;
-    outStream << "semantics error:     " << analyser.getError() << endl;
-    outStream << "function error:      " << fana.getError()     << endl;
-    outStream << "generator error:     " << cgen.getError()     << endl << endl;
+    // --serve compiles what client sends until it sends --shutdown
+    if (!socketPath.empty()) {
+        CompileServer server(options);
+        if (server.serve(socketPath)) return 0;
+        cerr << server.getError();
+        return 1;
+    }
 
-    /*
-    counted_ptr<Picture<counted_ptr<CellStatement>>> pic = file.head.getCell();
-    for (int i = 0; i < pic->getHeight(); i++) {
-        for (int j = 0; j < pic->getWidth(); j++) {
-            outStream << pic->get(j,i)->print();
-        }
-        outStream << endl;
+    if (batch.empty()) {
+        Compiler compiler(options);
+        CompileResult result = compiler.compile(name);
+        ofstream outStream;
+        outStream.open(Compiler::baseName(name) + "_log.txt");
+        result.writeLog(outStream);
+        if (!traceName.empty()) writeTrace(traceName, vector<CompileResult>(1, result));
+        return 0;
     }
 
-    for (int k = 0; k < file.blocks.size(); k++) {
-        outStream << endl;
-        pic = file.blocks[k].getLeft();
-        for (int i = 0; i < pic->getHeight(); i++) {
-            for (int j = 0; j < pic->getWidth(); j++) {
-                outStream << pic->get(j,i)->print();
-            }
-            outStream << endl;
-        }
-        outStream << file.blocks[k].getX() << " " <<file.blocks[k].getY() << endl;
-        outStream << endl;
-        pic = file.blocks[k].getRight();
-        for (int i = 0; i < pic->getHeight(); i++) {
-            for (int j = 0; j < pic->getWidth(); j++) {
-                outStream << pic->get(j,i)->print();
-            }
-            outStream << endl;
-        }
-        outStream << endl;
+    // --batch compiles many files on a pool of workers, one file per worker
+    // at a time, and writes one report for all of them instead of the logs
+    vector<string> files;
+    if (!batchFiles(batch, files)) {
+        cerr << "cannot read " << batch << endl;
+        return 1;
     }
+    // a profile belongs to one file
+    options.profileName = "";
+    options.minParallelBlocks = INT_MAX;
+    if (jobs < 1) jobs = 1;
+    vector<CompileResult> results(files.size());
+    WorkerPool::run(files.size(), jobs, [&](int i) {
+        Compiler compiler(options);
+        results[i] = compiler.compile(files[i]);
+    });
 
-    for (map<int, counted_ptr<Variable>>::iterator it = varTable.begin(); it != varTable.end(); it++) {
-        outStream << it->first << ":  ";
-        if (it->second.get()) outStream << it->second->print() << endl;
+    int failed = 0;
+    for (int i = 0; i < results.size(); i++) if (!results[i].succeeded()) failed++;
+    ofstream report(reportName);
+    report << "batch " << batch << ": " << files.size() << " files, "
+           << files.size() - failed << " successful, " << failed << " failed" << endl << endl;
+    for (int i = 0; i < results.size(); i++) {
+        if (results[i].succeeded()) report << "successful  " << results[i].name << (results[i].cached ? " (cached)" : "") << endl;
+        else report << "failed      " << results[i].name << " (" << results[i].failedStage() << ")" << endl;
+    }
+    for (int i = 0; i < results.size(); i++) {
+        if (results[i].succeeded() && !options.stats) continue;
+        report << endl << "----" << endl;
+        results[i].writeLog(report);
     }
-    outStream.close();
-    */
-    return 0;
+    if (!traceName.empty()) writeTrace(traceName, results);
+    return failed ? 1 : 0;
 }
@@ -0,0 +1,151 @@
+/*
+ * Compares the table driven TilingAutomaton with the original one that
+ * walked the TileTree for every pixel, on random small pictures: grids of
+ * cells like the ones in rule files, half of them with a few characters
+ * changed so that both accepted and rejected pictures come up.
+ *
+ *     tiling_check [pictures] [seed]
+ *
+ * Prints the counts and exits with 1 if the two disagree on any picture.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+// the headers below expect it
+using namespace std;
+
+#include "TileTree.h"
+#include "Picture.h"
+#include "TilingAutomaton.h"
+
+// the automaton as it was before the transition table, kept for comparison
+class ReferenceAutomaton {
+public:
+    ReferenceAutomaton() {
+        string standardTiles [] = {
+        "-+x|","|x+-", "x|-+", "###+", "##+#", "#+##", "+###",
+        "#+#|", "+#|#", "#|#+", "|#+#", "##+-", "##-+", "+-##", "-+##", "##--", "--##", "#|#|", "|#|#",
+        "xxxx", "|x|x", "x|x|", "--xx", "xx--",
+        "aaaa", "a+a|", "a|a|", "a|-+", "a|a+", "aa--", "aa+-", "aa-+", "###a", "##aa", "#a#a", "#a#+", "##a+", "aaa+",
+        "bbbb", "+b|b", "|b|b", "|b+-", "|b+b", "bb--", "bb+-", "bb-+", "##b#", "##bb", "b#b#", "b#+#", "##+b", "bb+b",
+        "cccc", "c|c+", "c|c|", "-+c|", "c+c|", "--cc", "+-cc", "-+cc", "#c##", "cc##", "#c#c", "#+#c", "c+##", "c+cc",
+        "dddd", "|d+d", "|d|d", "+d|d", "--dd", "+-dd", "-+dd", "d###", "dd##", "d#d#", "+#d#", "+d##", "+ddd",
+        "+-|y", "-+y|", "|y+-", "y|-+", "--yx", "yxxx", "|y|x", "yx--", "y|x|",
+        "+-|z", "--zz", "|z|z", "zzzz", "-+zd", "|z+d", "zzdd", "zdzd", "zddd", "-+z|", "|z+-", "zz--", "z|z|", "z|-+", "--zy", "zy--", "|z|y", "z|y|", "zyyy"};
+        tiles = new TileTree(standardTiles, 107);
+        pi['#']="#";
+        pi['+']="+";
+        pi['-']="-";
+        pi['|']="|";
+        pi['x']=" abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789+-/*(){},?.=_<>$%";
+        pi['y']="abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789+-/*(){},?.=_<>$%";
+        pi['z']=" ";
+        pi['a']=" ";
+        pi['b']=" ";
+        pi['c']=" ";
+        pi['d']=" ";
+    }
+
+    ~ReferenceAutomaton() {
+        delete tiles;
+    }
+
+    bool testPicture(const vector<string> & pic) {
+        int width = pic[0].size();
+        // two rows of states, '#' outside
+        vector<string> temp(2, string(width, '#'));
+        string tStr;
+        for (int j = 0; j < pic.size(); j++) {
+            for (int i = 0; i < width; i++) {
+                tStr.clear();
+                tStr.push_back((i > 0) ? temp[0][i-1] : '#');
+                tStr.push_back(temp[0][i]);
+                tStr.push_back((i > 0) ? temp[1][i-1] : '#');
+                string ttStr = tiles->getPossibleEndings(tStr, 0);
+                int sign = -1;
+                for (int k = 0; k < ttStr.size(); k++) {
+                    if (pi[ttStr[k]].find(pic[j][i]) < pi[ttStr[k]].size()) sign = k;
+                }
+                if (sign >= 0) temp[1][i] = ttStr[sign];
+                else return false;
+            }
+            temp[0] = temp[1];
+            temp[1] = string(width, '#');
+        }
+        return true;
+    }
+
+private:
+    TileTree * tiles;
+    map<char, string> pi;
+};
+
+// what testPicture needs of a picture
+struct Grid {
+    vector<string> rows;
+    int getWidth() { return rows[0].size(); }
+    int getHeight() { return rows.size(); }
+    char get(int i, int j) { return rows[j][i]; }
+};
+
+// small generator of our own, so the pictures are the same everywhere
+unsigned int nextRandom(unsigned int & state) {
+    state = state * 1103515245u + 12345u;
+    return (state >> 16) & 0x7fff;
+}
+
+vector<string> randomPicture(unsigned int & state) {
+    static const string content = " $ab01+-*(){},=";
+    static const string noise = " #+-|$ab0\t.";
+    int columns = 1 + nextRandom(state) % 3, rows = 1 + nextRandom(state) % 3;
+    vector<int> widths(columns);
+    for (int x = 0; x < columns; x++) widths[x] = 1 + nextRandom(state) % 4;
+    string border = "+";
+    for (int x = 0; x < columns; x++) border += string(widths[x], '-') + "+";
+    vector<string> pic(1, border);
+    for (int y = 0; y < rows; y++) {
+        string line = "|";
+        for (int x = 0; x < columns; x++) {
+            for (int k = 0; k < widths[x]; k++) line.push_back(content[nextRandom(state) % content.size()]);
+            line.push_back('|');
+        }
+        pic.push_back(line);
+        pic.push_back(border);
+    }
+    if (nextRandom(state) % 2) {
+        int changes = 1 + nextRandom(state) % 2;
+        for (int c = 0; c < changes; c++) {
+            string & line = pic[nextRandom(state) % pic.size()];
+            line[nextRandom(state) % line.size()] = noise[nextRandom(state) % noise.size()];
+        }
+    }
+    return pic;
+}
+
+int main(int argc, char** argv) {
+    int count = (argc > 1) ? atoi(argv[1]) : 200000;
+    unsigned int state = (argc > 2) ? atoi(argv[2]) : 1;
+    TilingAutomaton automaton;
+    ReferenceAutomaton reference;
+    int accepted = 0, mismatches = 0;
+    for (int n = 0; n < count; n++) {
+        Grid pic;
+        pic.rows = randomPicture(state);
+        bool result = automaton.testPicture(&pic);
+        if (result != reference.testPicture(pic.rows)) {
+            if (mismatches++ < 10) {
+                cout << "differs (table " << result << "):" << endl;
+                for (int j = 0; j < pic.rows.size(); j++) cout << "  " << pic.rows[j] << endl;
+            }
+        }
+        if (result) accepted++;
+    }
+    cout << count << " pictures, " << accepted << " accepted, " << count - accepted << " rejected, "
+         << mismatches << " differ" << endl;
+    return mismatches ? 1 : 0;
+}